@@ -0,0 +1,128 @@
+//  test-stream.c
+//
+//  Checks that twz_stream_open () keeps windows at or before the zero
+//  point, where f() has values: a window past zero is refused, and one
+//  that ends on zero reads every sample, the last one included, as f()
+//  computes it there.  Run by make check.
+
+// Written for the Linux port
+// 19 Oct 2026
+
+/*
+
+This is free and unencumbered software released into the public domain.
+
+Anyone is free to copy, modify, publish, use, compile, sell, or
+distribute this software, either in source code form or as a compiled
+binary, for any purpose, commercial or non-commercial, and by any
+means.
+
+In jurisdictions that recognize copyright laws, the author or authors
+of this software dedicate any and all copyright interest in the
+software to the public domain. We make this dedication for the benefit
+of the public at large and to the detriment of our heirs and
+successors. We intend this dedication to be an overt act of
+relinquishment in perpetuity of all present and future rights to this
+software under copyright law.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+
+For more information, please refer to <http://unlicense.org/>
+
+09 Dec 2012
+*/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "twz-stream.h"
+
+
+int64_t failures = 0;
+
+void check (int64_t ok, const char *what);
+int64_t read_window (long double dtz, long double neg, long double step);
+
+
+
+int main (void)
+{
+	struct twz_stream_options o;
+
+	twz_stream_defaults (&o);
+	o.neg = 1;
+	check (twz_stream_open (&o) == NULL, "a window past the zero point is refused");
+
+	o.neg = 1e-12;
+	check (twz_stream_open (&o) == NULL, "a window just past the zero point is refused");
+
+	// 1/3 day steps do not add up to 1 exactly, so the last sample lands
+	// within rounding of zero, on either side of it
+	check (read_window (1, 0, 480) == 4, "a window ending on the zero point reads f() at every sample");
+	check (read_window (7, 0, 1440 / 7.0) == 50, "a window ending on the zero point reads f() at every sample");
+	check (read_window (10, -2, 60) == 193, "a window stopping before the zero point reads f() at every sample");
+	check (read_window (-1, 0, 60) == 0, "a window starting after the zero point is empty");
+
+	if (failures) {
+		printf ("%ld check(s) failed\n", failures);
+		return EXIT_FAILURE;
+	}
+	printf ("test-stream: all checks passed\n");
+	return EXIT_SUCCESS;
+}
+
+
+
+/*--------------*/
+void check (int64_t ok, const char *what)
+{
+	if (!ok) {
+		printf ("FAILED: %s\n", what);
+		failures++;
+	}
+}
+
+
+
+/*  Read the window through a stream and compare every sample with f() at
+ *  its dtz (at zero for a dtz that rounded to just past it).  Returns the
+ *  number of samples read, or -1 for a stream that could not be opened or
+ *  a value that differs.  */
+/*--------------*/
+int64_t read_window (long double dtz, long double neg, long double step)
+{
+	struct twz_stream_options o;
+	struct twz_stream *s;
+	struct twz_batch b;
+	long double powers[TWZ_POWERS];
+	int64_t n, set, read = 0, ok = 1;
+
+	twz_stream_defaults (&o);
+	o.dtz = dtz;
+	o.neg = neg;
+	o.step = step;
+	o.batch = 16;
+	if ((s = twz_stream_open (&o)) == NULL)
+		return -1;
+
+	twz_powers (powers, o.wave_factor);
+	while (twz_stream_next (s, &b) > 0) {
+		for (n = 0; n < b.count; n++)
+			for (set = 0; set < TWZ_SETS; set++)
+				if (!isfinite (b.values[n][set])
+					|| b.values[n][set] != twz_f (fmaxl (b.dtz[n], 0.0), twz_w[set], powers))
+					ok = 0;
+		read += b.count;
+	}
+	twz_stream_close (s);
+
+	return ok ? read : -1;
+}
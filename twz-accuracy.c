@@ -0,0 +1,518 @@
+//  twz-accuracy.c
+//
+// Based on source code by the original author: Peter Meyer
+//  Compare alternative ways of evaluating the timewave with the
+//  reference long double f() over random and adversarial inputs and
+//  report their error and speed.
+
+// Written for the Linux port
+// 19 Oct 2026
+
+/*
+
+This is free and unencumbered software released into the public domain.
+
+Anyone is free to copy, modify, publish, use, compile, sell, or
+distribute this software, either in source code form or as a compiled
+binary, for any purpose, commercial or non-commercial, and by any
+means.
+
+In jurisdictions that recognize copyright laws, the author or authors
+of this software dedicate any and all copyright interest in the
+software to the public domain. We make this dedication for the benefit
+of the public at large and to the detriment of our heirs and
+successors. We intend this dedication to be an overt act of
+relinquishment in perpetuity of all present and future rights to this
+software under copyright law.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+
+For more information, please refer to <http://unlicense.org/>
+
+09 Dec 2012
+*/
+
+#include <math.h>
+#include <float.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include "twz-kernel.h"
+#include "twz-levels.h"
+
+
+#define FALSE 0
+#define TRUE  1
+#define NUM_POWERS TWZ_POWERS
+#define PREC 16 // long double (80 bit) numbers have about 16 significant digits  INTEL / AMD / x86_64
+//#define PREC 32 // long double (128 bit) numbers have about 32 significant digits (QUAD PRECISION)
+#define NUM_SETS TWZ_SETS
+#define NUM_DATA_POINTS TWZ_DATA_POINTS
+#define NUM_CLASSES 5
+
+
+long double powers[NUM_POWERS];
+double powers_d[NUM_POWERS];
+
+//  Powers of (normally) 64.
+//  Due to the limitations of double precision
+//  floating point arithmetic these values are
+//  exact only up to powers[8] for powers of 64.
+
+int64_t wave_factor = 64;		//  default wave factor
+
+
+char *usage = "\nUsage: twz-accuracy [n=nn] [wfs=a:b] [engines=a,b,..] [seed=nn]."
+"\n n = inputs per class and wave factor (default 20)"
+"\n wfs = range of wave factors (default 2:10000)"
+"\n engines = engines to compare with f() (default all: double,shared,fmod)"
+"\n seed = seed of the random inputs (default 1)"
+"\n\nThis program evaluates the timewave with the reference long double f() and with"
+"\nalternative engines over random inputs, segment boundaries, tiny and very large"
+"\ndtz for every wave factor of the range, and reports the error of every engine"
+"\nand its speed relative to f().  Errors are given in units in the last place (ULP)"
+"\nof a double at the larger of |f()| and dtz / wf^3, the size of the wave near dtz,"
+"\nso that points where the wave is all but zero do not swamp the figures.\n";
+
+
+char *set_name[NUM_SETS] =
+{ "Kelley", "Watkins", "Sheliak", "Huang Ti" };
+
+char *class_name[NUM_CLASSES] =
+{ "random", "coarse boundaries", "fine boundaries", "tiny", "very large" };
+
+
+char *title = "Engine, Set, Inputs, Failures, Max ULP, Mean ULP, Max Abs Error, Mean Abs Error, Worst DTZ, Worst WF, Speed vs f()";
+
+
+//  Coarse levels shared between neighbouring points: the twz-point batch
+//  engine, from libtwz.a
+struct twz_levels cache;
+
+
+//  An engine evaluates all the sets at one point
+struct Engine
+{
+	char *name;
+	void (*eval) (long double x, long double *ans);
+	int64_t enabled;
+	double seconds;
+	int64_t inputs[NUM_SETS], failures[NUM_SETS];
+	long double max_ulp[NUM_SETS], sum_ulp[NUM_SETS];
+	long double max_abs[NUM_SETS], sum_abs[NUM_SETS];
+	long double worst_x[NUM_SETS];
+	int64_t worst_wf[NUM_SETS];
+};
+
+
+void inputerror (void);
+void set_powers (void);
+void make_inputs (long double *x, int64_t n);
+int compare_inputs (const void *a, const void *b);
+long double ulp (long double r, long double x);
+double now (void);
+uint64_t splitmix64 (void);
+long double uniform (void);
+
+void eval_reference (long double x, long double *ans);
+void eval_double (long double x, long double *ans);
+void eval_shared (long double x, long double *ans);
+void eval_fmod (long double x, long double *ans);
+
+long double mult_power (long double x, int64_t i);
+long double div_power (long double x, int64_t i);
+double f_double (double x, int64_t number_set);
+long double f_fmod (long double x, int64_t number_set);
+
+
+#define NUM_ENGINES 3
+struct Engine engines[NUM_ENGINES] =
+{
+	{ "double", eval_double, TRUE },		//  the same loops in double precision
+	{ "shared", eval_shared, TRUE },		//  coarse levels shared between sorted points
+	{ "fmod", eval_fmod, TRUE },			//  v() with double fmod() and floor(), as first ported
+};
+
+uint64_t rng_state = 1;
+
+
+/*-----------------------------*/
+int main (int argc, char *argv[])
+{
+	int64_t i, e, n = 20, wf_lo = 2, wf_hi = 10000, count, number_set;
+	long double *x, (*ref)[NUM_SETS], (*ans)[NUM_SETS], err, u;
+	double t0, ref_seconds = 0.0;
+	struct Engine *en;
+	char *p;
+
+	for (i = 1; i < argc; i++) {
+		if (!memcmp (argv[i], "n=", 2))
+			n = atoi (&argv[i][2]);
+		else if (!memcmp (argv[i], "wfs=", 4)) {
+			wf_lo = wf_hi = atoi (&argv[i][4]);
+			if ((p = strchr (argv[i], ':')) != NULL)
+				wf_hi = atoi (p + 1);
+		} else if (!memcmp (argv[i], "engines=", 8)) {
+			for (e = 0; e < NUM_ENGINES; e++)
+				engines[e].enabled = strstr (&argv[i][8], engines[e].name) != NULL;
+		} else if (!memcmp (argv[i], "seed=", 5))
+			rng_state = strtoull (&argv[i][5], NULL, 10);
+		else {
+			printf ("%s", usage);
+			inputerror ();
+		}
+	}
+
+	if (n < 1 || wf_lo < 2 || wf_hi > 10000 || wf_lo > wf_hi) {
+		printf ("%s", usage);
+		inputerror ();
+	}
+
+	count = n * NUM_CLASSES;
+	x = malloc (count * sizeof (long double));
+	ref = malloc (count * sizeof (*ref));
+	ans = malloc (count * sizeof (*ans));
+	if (x == NULL || ref == NULL || ans == NULL)
+		inputerror ();
+
+	for (wave_factor = wf_lo; wave_factor <= wf_hi; wave_factor++) {
+		set_powers ();
+		make_inputs (x, n);
+
+		// Sorted, so the shared engine sees the batches it is meant for
+		qsort (x, count, sizeof (long double), compare_inputs);
+
+		t0 = now ();
+		for (i = 0; i < count; i++)
+			eval_reference (x[i], ref[i]);
+		ref_seconds += now () - t0;
+
+		for (e = 0; e < NUM_ENGINES; e++) {
+			en = &engines[e];
+			if (!en->enabled)
+				continue;
+
+			// Timed over the whole loop, as the reference is, and
+			// compared afterwards
+			twz_levels_start (&cache, wave_factor);
+			t0 = now ();
+			for (i = 0; i < count; i++)
+				en->eval (x[i], ans[i]);
+			en->seconds += now () - t0;
+
+			for (i = 0; i < count; i++) {
+				for (number_set = 0; number_set < NUM_SETS; number_set++) {
+					en->inputs[number_set]++;
+					if (!isfinite (ans[i][number_set])) {
+						en->failures[number_set]++;
+						continue;
+					}
+
+					err = fabsl (ans[i][number_set] - ref[i][number_set]);
+					u = err / ulp (ref[i][number_set], x[i]);
+					en->sum_abs[number_set] += err;
+					en->sum_ulp[number_set] += u;
+					if (err > en->max_abs[number_set])
+						en->max_abs[number_set] = err;
+					if (u > en->max_ulp[number_set]) {
+						en->max_ulp[number_set] = u;
+						en->worst_x[number_set] = x[i];
+						en->worst_wf[number_set] = wave_factor;
+					}
+				}
+			}
+		}
+	}
+
+	printf ("\nInput classes:");
+	for (i = 0; i < NUM_CLASSES; i++)
+		printf (" %s%s", class_name[i], i < NUM_CLASSES - 1 ? "," : "");
+	printf ("; %ld inputs per class for each wave factor from %ld to %ld\n", n, wf_lo, wf_hi);
+	printf ("\n%s\n", title);
+
+	for (e = 0; e < NUM_ENGINES; e++) {
+		en = &engines[e];
+		if (!en->enabled)
+			continue;
+
+		for (number_set = 0; number_set < NUM_SETS; number_set++) {
+			i = en->inputs[number_set] - en->failures[number_set];
+			printf ("%s ,%s ,%ld ,%ld ,%.3Lf ,%.3Lf ,%.*Le ,%.*Le ,%.*Le ,%ld ,%.2f ,\n",
+				en->name, set_name[number_set], en->inputs[number_set], en->failures[number_set],
+				en->max_ulp[number_set], i ? en->sum_ulp[number_set] / i : 0.0L,
+				PREC, en->max_abs[number_set], PREC, i ? en->sum_abs[number_set] / i : 0.0L,
+				PREC, en->worst_x[number_set], en->worst_wf[number_set],
+				en->seconds > 0.0 ? ref_seconds / en->seconds : 0.0);
+		}
+	}
+
+	return 0;
+}
+
+
+
+/*  n inputs of each class:
+ *    random: log-uniform dtz from 1e-9 to 1e7 days
+ *    coarse boundaries: multiples of powers[i], and one ulp either side
+ *    fine boundaries: multiples of 1/powers[i], and one ulp either side
+ *    tiny: log-uniform from 1e-300 to 1e-9 days
+ *    very large: log-uniform from 1e7 days to powers[NUM_POWERS - 1] / 2 (or 1e15)
+ *  Every input is a double, so the double engine sees the same points.
+ */
+/*--------------*/
+void make_inputs (long double *x, int64_t n)
+{
+	int64_t i, c, level;
+	long double b, top;
+
+	top = powers[NUM_POWERS - 1] / 2 < 1e15 ? powers[NUM_POWERS - 1] / 2 : 1e15;
+
+	for (c = 0; c < NUM_CLASSES; c++) {
+		for (i = 0; i < n; i++, x++) {
+			switch (c) {
+			case 0:
+				*x = powl (10.0, -9 + 16 * uniform ());
+				break;
+			case 1:
+			case 2:
+				level = splitmix64 () % 4;
+				if (c == 1)
+					b = powers[level] * (1 + splitmix64 () % 100000);
+				else
+					b = (1 + splitmix64 () % 100000) / powers[level + 1];
+				*x = (i % 3 == 0) ? (double) b : (i % 3 == 1) ? nextafter (b, 0.0) : nextafter (b, INFINITY);
+				break;
+			case 3:
+				*x = powl (10.0, -300 + 291 * uniform ());
+				break;
+			default:
+				*x = powl (10.0, 7 + (log10l (top) - 7) * uniform ());
+				break;
+			}
+
+			*x = (double) *x;
+		}
+	}
+}
+
+
+
+/*--------------*/
+int compare_inputs (const void *a, const void *b)
+{
+	long double x = *(long double *) a, y = *(long double *) b;
+
+	return ((x > y) - (x < y));
+}
+
+
+
+//  Unit in the last place of a double near r, or near the size of the wave at x
+/*--------------*/
+long double ulp (long double r, long double x)
+{
+	double d = fmaxl (fabsl (r), div_power (x, 3));
+
+	if (d < DBL_MIN)
+		return DBL_MIN * DBL_EPSILON;
+	return nextafter (d, INFINITY) - d;
+}
+
+
+
+/*--------------*/
+double now (void)
+{
+	struct timespec ts;
+
+	clock_gettime (CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+
+
+/*--------------*/
+uint64_t splitmix64 (void)
+{
+	uint64_t z = (rng_state += 0x9E3779B97F4A7C15ULL);
+
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	return z ^ (z >> 31);
+}
+
+//  Uniform in [0, 1)
+/*--------------*/
+long double uniform (void)
+{
+	return (splitmix64 () >> 11) * (1.0L / 9007199254740992.0L);
+}
+
+
+
+/*--------------*/
+void eval_reference (long double x, long double *ans)
+{
+	int64_t number_set;
+
+	for (number_set = 0; number_set < NUM_SETS; number_set++)
+		ans[number_set] = twz_f (x, twz_w[number_set], powers);
+}
+
+/*--------------*/
+void eval_double (long double x, long double *ans)
+{
+	int64_t number_set;
+
+	for (number_set = 0; number_set < NUM_SETS; number_set++)
+		ans[number_set] = f_double (x, number_set);
+}
+
+/*--------------*/
+void eval_fmod (long double x, long double *ans)
+{
+	int64_t number_set;
+
+	for (number_set = 0; number_set < NUM_SETS; number_set++)
+		ans[number_set] = f_fmod (x, number_set);
+}
+
+
+
+/*  Same as f() for all the sets at once, taking the coarse levels that x
+ *  shares with the previous point from the cache (see twz-levels.h)
+ */
+/*--------------*/
+void eval_shared (long double x, long double *ans)
+{
+	twz_levels_eval (&cache, x, ans, NULL);
+}
+
+
+
+//  f() in double precision throughout
+/*--------------*/
+double f_double (double x, int64_t number_set)
+{
+	uint64_t i;
+	double sum = 0.0, last_sum = 0.0, y, z;
+	int64_t k, kn;
+
+	if (x) {
+		for (i = 0; i < NUM_POWERS && x >= powers_d[i]; i++) {
+			y = x / powers_d[i];
+			k = (int64_t) fmod (y, NUM_DATA_POINTS);
+			kn = (k + 1) % NUM_DATA_POINTS;
+			z = y - floor (y);
+			sum += (twz_w[number_set][k] + (twz_w[number_set][kn] - twz_w[number_set][k]) * z) * powers_d[i];
+		}
+
+		i = 0;
+		do {
+			if (++i > TWZ_CALC_PREC + 2 || i >= NUM_POWERS)
+				break;
+
+			last_sum = sum;
+			y = x * powers_d[i];
+			k = (int64_t) fmod (y, NUM_DATA_POINTS);
+			kn = (k + 1) % NUM_DATA_POINTS;
+			z = y - floor (y);
+			sum += (twz_w[number_set][k] + (twz_w[number_set][kn] - twz_w[number_set][k]) * z) / powers_d[i];
+		} while ((sum == 0.0) || (sum > last_sum));
+	}
+
+	return sum / powers_d[3];
+}
+
+
+
+/*  f() with v() rounding y to a double in fmod() and floor(), as it was
+ *  first ported.  The original also lacked the NUM_POWERS guard and ran
+ *  past the powers table (printing -nan) where the rounding keeps the
+ *  fine loop going; here the loop stops at the end of the table, so this
+ *  engine shows the error of the rounding, not those failures.
+ */
+/*--------------*/
+long double f_fmod (long double x, int64_t number_set)
+{
+	uint64_t i;
+	long double sum = 0.0, last_sum = 0.0, y, z;
+	int64_t k, kn;
+
+	if (x) {
+		for (i = 0; x >= powers[i]; i++) {
+			y = div_power (x, i);
+			k = (int64_t) (fmod (y, (long double) NUM_DATA_POINTS));
+			kn = (k + 1) % NUM_DATA_POINTS;
+			z = y - floor (y);
+			sum += mult_power (z == 0.0 ? (long double) twz_w[number_set][k] :
+				(twz_w[number_set][kn] - twz_w[number_set][k]) * z + twz_w[number_set][k], i);
+		}
+
+		i = 0;
+		do {
+			if (++i > TWZ_CALC_PREC + 2 || i >= NUM_POWERS)
+				break;
+
+			last_sum = sum;
+			y = mult_power (x, i);
+			k = (int64_t) (fmod (y, (long double) NUM_DATA_POINTS));
+			kn = (k + 1) % NUM_DATA_POINTS;
+			z = y - floor (y);
+			sum += div_power (z == 0.0 ? (long double) twz_w[number_set][k] :
+				(twz_w[number_set][kn] - twz_w[number_set][k]) * z + twz_w[number_set][k], i);
+		} while ((sum == 0.0) || (sum > last_sum));
+	}
+
+	sum = div_power (sum, 3);
+	return (sum);
+}
+
+
+
+//  wave_factor is a global variable
+/*-----------------*/
+void set_powers (void)
+{
+	uint64_t j;
+
+	twz_powers (powers, wave_factor);
+
+	for (j = 0; j < NUM_POWERS; j++)
+		powers_d[j] = powers[j];
+}
+
+
+
+/*-----------------------*/
+long double mult_power (long double x, int64_t i)
+{
+	x *= powers[i];
+	return (x);
+}
+
+
+
+/*----------------------*/
+long double div_power (long double x, int64_t i)
+{
+	x /= powers[i];
+	return (x);
+}
+
+
+
+void inputerror (void)
+{
+	printf ("\nError: Invalid input, exiting.\n\n");
+	exit (EXIT_SUCCESS);
+}
@@ -0,0 +1,415 @@
+//  twz-bench.c
+//
+//  Run twz-generator and twz-generator-threaded over fixed reference
+//  windows at several steps, thread counts and output sinks, and write
+//  the wall time, samples per second, CPU use and parallel efficiency of
+//  every run as JSON, so scaling can be compared across commits and
+//  machines.
+
+// Written for the Linux port
+// 19 Oct 2026
+
+/*
+
+This is free and unencumbered software released into the public domain.
+
+Anyone is free to copy, modify, publish, use, compile, sell, or
+distribute this software, either in source code form or as a compiled
+binary, for any purpose, commercial or non-commercial, and by any
+means.
+
+In jurisdictions that recognize copyright laws, the author or authors
+of this software dedicate any and all copyright interest in the
+software to the public domain. We make this dedication for the benefit
+of the public at large and to the detriment of our heirs and
+successors. We intend this dedication to be an overt act of
+relinquishment in perpetuity of all present and future rights to this
+software under copyright law.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+
+For more information, please refer to <http://unlicense.org/>
+
+09 Dec 2012
+*/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/utsname.h>
+
+
+#define FALSE 0
+#define TRUE  1
+#define MAX_THREADS 256
+#define MAX_COUNTS 32			//  thread counts in one benchmark
+#define NUM_WINDOWS 3
+#define NUM_STEPS 3
+#define NUM_SINKS 4
+#define SINK_FILE 0				//  CSV to a file
+#define SINK_BIN  1				//  binary to a file (twz-generator-threaded only)
+#define SINK_NULL 2				//  CSV to /dev/null
+#define SINK_PIPE 3				//  CSV through a pipe, read by the driver
+
+
+/*  A reference window, in the arguments of the generators: dtz days
+ *  before zero down to neg days after it (negative neg stops before zero)  */
+struct Window
+{
+	char *name;
+	double dtz, neg;
+};
+
+/*  What one run of a generator took  */
+struct Run
+{
+	double wall;				//  seconds
+	double cpu;					//  user + system seconds of the generator
+	int64_t bytes;				//  output size, -1 when not known (/dev/null)
+	int status;					//  exit status
+};
+
+
+struct Window window[NUM_WINDOWS] =
+{
+	{ "far", 36525, -36425 },	//  100 days, 100 years before zero
+	{ "near", 100, 0 },			//  the last 100 days before zero
+	{ "spanning", 50, 50 }		//  50 days either side of zero
+};
+
+double step_minutes[NUM_STEPS] = { 60, 10, 1 };
+
+char *sink_name[NUM_SINKS] = { "file", "bin", "null", "pipe" };
+
+
+char *usage = "\nUsage: twz-bench [options]."
+"\n threads=a,b,... = thread counts of twz-generator-threaded"
+"\n                   (default: powers of 2 up to the processor count, and it)"
+"\n reps=n = runs of each case, the fastest one is kept (default 1)"
+"\n scale=k = divide the steps by k for k times the samples (default 1)"
+"\n wf=n = wave factor (default 64, range 2-10000)"
+"\n dir=path = directory for the file sinks (default /tmp)"
+"\n bin=path = directory of the generators (default .)"
+"\n label=text = recorded in the JSON, e.g. the commit"
+"\n\nThis program times the generators over fixed reference windows and writes JSON.\n";
+
+
+int64_t counts[MAX_COUNTS];
+int64_t num_counts = 0;
+int64_t reps = 1, wave_factor = 64;
+double scale = 1.0;
+char *out_dir = "/tmp";
+char *bin_dir = ".";
+char *label = "";
+
+
+void inputerror (void);
+double now (void);
+void run_generator (char *program, struct Window *win, double step, int64_t threads, int64_t sink, struct Run *r);
+void print_run (char *program, struct Window *win, double step, int64_t threads, int64_t sink, int64_t samples,
+	struct Run *r, struct Run *base, struct Run *serial, int64_t first);
+void print_string (char *s);
+
+
+/*-----------------------------*/
+int main (int argc, char *argv[])
+{
+	int64_t i, j, k, t, sink, cpus, samples, first = TRUE, have_base, have_serial;
+	double step;
+	char *p;
+	struct Run r, best, base, serial;
+	struct utsname host;
+	time_t started = time (NULL);
+	char date[64];
+
+	cpus = sysconf (_SC_NPROCESSORS_ONLN);
+	if (cpus < 1)
+		cpus = 1;
+
+	for (i = 1; i < argc; i++) {
+		if (!memcmp (argv[i], "threads=", 8)) {
+			for (p = &argv[i][8], num_counts = 0; *p; p++) {
+				if (num_counts == MAX_COUNTS)
+					inputerror ();
+				counts[num_counts] = strtol (p, &p, 10);
+				if (counts[num_counts] < 1 || counts[num_counts] > MAX_THREADS || (*p && *p != ','))
+					inputerror ();
+				num_counts++;
+				if (!*p)
+					break;
+			}
+		} else if (!memcmp (argv[i], "reps=", 5)) {
+			reps = atol (&argv[i][5]);
+			if (reps < 1)
+				inputerror ();
+		} else if (!memcmp (argv[i], "scale=", 6)) {
+			scale = atof (&argv[i][6]);
+			if (scale <= 0)
+				inputerror ();
+		} else if (!memcmp (argv[i], "wf=", 3)) {
+			wave_factor = atol (&argv[i][3]);
+			if (wave_factor < 2 || wave_factor > 10000)
+				inputerror ();
+		} else if (!memcmp (argv[i], "dir=", 4)) {
+			out_dir = &argv[i][4];
+		} else if (!memcmp (argv[i], "bin=", 4)) {
+			bin_dir = &argv[i][4];
+		} else if (!memcmp (argv[i], "label=", 6)) {
+			label = &argv[i][6];
+		} else {
+			printf ("%s", usage);
+			inputerror ();
+		}
+	}
+
+	if (num_counts == 0) {
+		for (t = 1; t < cpus && num_counts < MAX_COUNTS - 1; t *= 2)
+			counts[num_counts++] = t;
+		counts[num_counts++] = cpus < MAX_THREADS ? cpus : MAX_THREADS;
+	}
+
+	// Ascending, so the one-thread run of each case comes first
+	for (i = 1; i < num_counts; i++)
+		for (j = i; j > 0 && counts[j] < counts[j - 1]; j--) {
+			t = counts[j];
+			counts[j] = counts[j - 1];
+			counts[j - 1] = t;
+		}
+
+	uname (&host);
+	strftime (date, sizeof (date), "%Y-%m-%dT%H:%M:%SZ", gmtime (&started));
+
+	printf ("{\n  \"label\": ");
+	print_string (label);
+	printf (",\n  \"date\": \"%s\",\n  \"host\": ", date);
+	print_string (host.nodename);
+	printf (",\n  \"machine\": ");
+	print_string (host.machine);
+	printf (",\n  \"cpus\": %ld,\n  \"wave_factor\": %ld,\n  \"reps\": %ld,\n  \"scale\": %g,\n  \"runs\": [",
+		cpus, wave_factor, reps, scale);
+
+	for (i = 0; i < NUM_WINDOWS; i++)
+		for (j = 0; j < NUM_STEPS; j++)
+			for (sink = 0; sink < NUM_SINKS; sink++) {
+				step = step_minutes[j] / scale;
+				samples = (int64_t) floor ((window[i].dtz + window[i].neg) / (step / 60 / 24) + 1e-9) + 1;
+				have_base = have_serial = FALSE;
+
+				// twz-generator first (it has no binary output), then the
+				// threaded one at each thread count
+				for (k = -1; k < num_counts; k++) {
+					if (k < 0 && sink == SINK_BIN)
+						continue;
+
+					best.wall = -1;
+					for (t = 0; t < reps; t++) {
+						run_generator (k < 0 ? "twz-generator" : "twz-generator-threaded", &window[i], step,
+							k < 0 ? 1 : counts[k], sink, &r);
+						if (best.wall < 0 || r.wall < best.wall)
+							best = r;
+					}
+
+					if (k < 0) {
+						serial = best;
+						have_serial = TRUE;
+					} else if (counts[k] == 1) {
+						base = best;
+						have_base = TRUE;
+					}
+
+					fprintf (stderr, "%s step=%g %s %s threads=%ld: %.3f s\n", window[i].name, step, sink_name[sink],
+						k < 0 ? "twz-generator" : "twz-generator-threaded", k < 0 ? 1 : counts[k], best.wall);
+
+					print_run (k < 0 ? "twz-generator" : "twz-generator-threaded", &window[i], step,
+						k < 0 ? 1 : counts[k], sink, samples, &best, have_base ? &base : NULL,
+						have_serial ? &serial : NULL, first);
+					first = FALSE;
+				}
+			}
+
+	printf ("\n  ]\n}\n");
+	return 0;
+}
+
+
+
+/*  Run a generator once with its output going to the sink  */
+/*--------------*/
+void run_generator (char *program, struct Window *win, double step, int64_t threads, int64_t sink, struct Run *r)
+{
+	char path[4096], file[4096], dtz[64], neg[64], minutes[64], wf[64], thread_arg[64], buffer[65536];
+	char *args[16];
+	int64_t n = 0;
+	int fd = -1, pipe_fd[2], status = 0;
+	ssize_t got;
+	pid_t pid;
+	struct rusage usage;
+	struct stat st;
+	double start;
+
+	snprintf (path, sizeof (path), "%s/%s", bin_dir, program);
+	snprintf (file, sizeof (file), "%s/twz-bench-%d.out", out_dir, (int) getpid ());
+	snprintf (dtz, sizeof (dtz), "%.17g", win->dtz);
+	snprintf (neg, sizeof (neg), "%.17g", win->neg);
+	snprintf (minutes, sizeof (minutes), "%.17g", step);
+	snprintf (wf, sizeof (wf), "%ld", wave_factor);
+	snprintf (thread_arg, sizeof (thread_arg), "threads=%ld", threads);
+
+	args[n++] = path;
+	args[n++] = dtz;
+	args[n++] = neg;
+	args[n++] = minutes;
+	args[n++] = wf;
+	if (strcmp (program, "twz-generator")) {
+		args[n++] = thread_arg;
+		args[n++] = "yes";
+		if (sink == SINK_BIN)
+			args[n++] = "out=bin";
+	}
+	args[n] = NULL;
+
+	if (sink == SINK_PIPE && pipe (pipe_fd)) {
+		printf ("\nError: Cannot create a pipe, exiting.\n\n");
+		exit (EXIT_FAILURE);
+	}
+
+	r->bytes = -1;
+	start = now ();
+	pid = fork ();
+	if (pid < 0) {
+		printf ("\nError: Cannot start %s, exiting.\n\n", path);
+		exit (EXIT_FAILURE);
+	}
+
+	if (pid == 0) {
+		if (sink == SINK_PIPE) {
+			close (pipe_fd[0]);
+			fd = pipe_fd[1];
+		} else if (sink == SINK_NULL)
+			fd = open ("/dev/null", O_WRONLY);
+		else
+			fd = open (file, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+		if (fd < 0)
+			_exit (126);
+		dup2 (fd, STDOUT_FILENO);
+		close (fd);
+
+		// the plan lines
+		fd = open ("/dev/null", O_WRONLY);
+		dup2 (fd, STDERR_FILENO);
+		close (fd);
+
+		execv (path, args);
+		_exit (127);
+	}
+
+	if (sink == SINK_PIPE) {
+		close (pipe_fd[1]);
+		r->bytes = 0;
+		while ((got = read (pipe_fd[0], buffer, sizeof (buffer))) > 0)
+			r->bytes += got;
+		close (pipe_fd[0]);
+	}
+
+	wait4 (pid, &status, 0, &usage);
+	r->wall = now () - start;
+	r->cpu = usage.ru_utime.tv_sec + usage.ru_utime.tv_usec * 1e-6 + usage.ru_stime.tv_sec + usage.ru_stime.tv_usec * 1e-6;
+	r->status = WIFEXITED (status) ? WEXITSTATUS (status) : 128 + WTERMSIG (status);
+
+	if (sink == SINK_FILE || sink == SINK_BIN) {
+		if (!stat (file, &st))
+			r->bytes = st.st_size;
+		unlink (file);
+	}
+
+	if (r->status)
+		fprintf (stderr, "%s exited with status %d\n", path, r->status);
+}
+
+
+
+/*  One element of the runs array.  speedup and efficiency are against the
+ *  one-thread run of twz-generator-threaded on the same case, speedup_serial
+ *  against twz-generator; null where there is nothing to compare with.
+ *  cpu_utilization is the CPU time over the wall time, the average number
+ *  of processors kept busy.
+ */
+/*--------------*/
+void print_run (char *program, struct Window *win, double step, int64_t threads, int64_t sink, int64_t samples,
+	struct Run *r, struct Run *base, struct Run *serial, int64_t first)
+{
+	printf ("%s\n    {\"program\": \"%s\", \"window\": \"%s\", \"dtz\": %.17g, \"neg\": %.17g, \"step_minutes\": %.17g, ",
+		first ? "" : ",", program, win->name, win->dtz, win->neg, step);
+	printf ("\"threads\": %ld, \"sink\": \"%s\", \"samples\": %ld, \"exit_status\": %d, ",
+		threads, sink_name[sink], samples, r->status);
+
+	if (r->bytes >= 0)
+		printf ("\"bytes\": %ld, ", r->bytes);
+	else
+		printf ("\"bytes\": null, ");
+
+	printf ("\"wall_seconds\": %.6f, \"cpu_seconds\": %.6f, \"samples_per_second\": %.1f, \"cpu_utilization\": %.3f, ",
+		r->wall, r->cpu, r->wall > 0 ? samples / r->wall : 0.0, r->wall > 0 ? r->cpu / r->wall : 0.0);
+
+	if (base && r->wall > 0)
+		printf ("\"speedup\": %.3f, \"efficiency\": %.3f, ", base->wall / r->wall, base->wall / r->wall / threads);
+	else
+		printf ("\"speedup\": null, \"efficiency\": null, ");
+
+	if (serial && r->wall > 0)
+		printf ("\"speedup_serial\": %.3f}", serial->wall / r->wall);
+	else
+		printf ("\"speedup_serial\": null}");
+}
+
+
+
+/*  A JSON string  */
+/*--------------*/
+void print_string (char *s)
+{
+	putchar ('"');
+	for (; *s; s++) {
+		if (*s == '"' || *s == '\\')
+			printf ("\\%c", *s);
+		else if ((unsigned char) *s < 0x20)
+			printf ("\\u%04x", *s);
+		else
+			putchar (*s);
+	}
+	putchar ('"');
+}
+
+
+
+/*  Seconds on a monotonic clock  */
+/*--------------*/
+double now (void)
+{
+	struct timespec t;
+
+	clock_gettime (CLOCK_MONOTONIC, &t);
+	return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+
+
+void inputerror (void)
+{
+	printf ("\nError: Invalid input, exiting.\n\n");
+	exit (EXIT_SUCCESS);
+}
@@ -0,0 +1,312 @@
+//  twz-bound.c
+//
+// Based on source code by the original author: Peter Meyer
+//  Interval bounds of the timewave (twz-bound.h), from the range of the
+//  number sets over the segments each level of f() covers, and anytime
+//  evaluation with the bound of the fine levels still to come.
+
+// Written for the Linux port
+// 19 Oct 2026
+
+/*
+
+This is free and unencumbered software released into the public domain.
+
+Anyone is free to copy, modify, publish, use, compile, sell, or
+distribute this software, either in source code form or as a compiled
+binary, for any purpose, commercial or non-commercial, and by any
+means.
+
+In jurisdictions that recognize copyright laws, the author or authors
+of this software dedicate any and all copyright interest in the
+software to the public domain. We make this dedication for the benefit
+of the public at large and to the detriment of our heirs and
+successors. We intend this dedication to be an overt act of
+relinquishment in perpetuity of all present and future rights to this
+software under copyright law.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+
+For more information, please refer to <http://unlicense.org/>
+
+09 Dec 2012
+*/
+
+#include <math.h>
+#include <float.h>
+#include <stdint.h>
+#include <time.h>
+
+#include <pthread.h>
+
+#include "twz-bound.h"
+
+
+#define FALSE 0
+#define TRUE  1
+#define NUM_POWERS TWZ_POWERS
+#define NUM_SETS TWZ_SETS
+#define NUM_DATA_POINTS TWZ_DATA_POINTS
+
+
+static long double w_min[NUM_SETS], w_max[NUM_SETS];
+static pthread_once_t w_range_once = PTHREAD_ONCE_INIT;
+
+
+static void set_w_range (void);
+static void v_range (long double y0, long double y1, int64_t number_set, long double *lo, long double *hi);
+static void refine_error (struct twz_refine *r);
+static long double seconds_now (void);
+
+
+
+/*--------------*/
+int twz_bound (long double a, long double b, int64_t wave_factor, long double lo[TWZ_SETS], long double hi[TWZ_SETS])
+{
+	long double p[NUM_POWERS];
+	int64_t set;
+
+	if (wave_factor < 2 || wave_factor > 10000 || !(a >= 0.0) || !(b >= a) || isinf (b))
+		return FALSE;
+
+	twz_powers (p, wave_factor);
+
+	for (set = 0; set < NUM_SETS; set++)
+		twz_bound_set (a, b, set, p, &lo[set], &hi[set]);
+
+	return TRUE;
+}
+
+
+
+/*  The sums run exactly as in f(): the coarse levels from the finest up,
+ *  then the fine levels one by one, so a set that reaches the end of the
+ *  fine loop holds f()'s own value.
+ */
+/*--------------*/
+int twz_refine_start (struct twz_refine *r, long double x, int64_t wave_factor)
+{
+	int64_t i, set;
+
+	if (wave_factor < 2 || wave_factor > 10000 || !(x >= 0.0) || isinf (x))
+		return FALSE;
+
+	pthread_once (&w_range_once, set_w_range);
+
+	r->x = x;
+	r->wave_factor = wave_factor;
+	r->level = 0;
+	twz_powers (r->powers, wave_factor);
+
+	for (set = 0; set < NUM_SETS; set++) {
+		r->sum[set] = 0.0;
+		r->open[set] = x != 0.0;
+		if (x)
+			for (i = 0; x >= r->powers[i]; i++)
+				r->sum[set] += twz_v (x / r->powers[i], twz_w[set], NULL) * r->powers[i];
+	}
+
+	refine_error (r);
+	return TRUE;
+}
+
+
+
+/*--------------*/
+int twz_refine_next (struct twz_refine *r)
+{
+	int64_t i, set;
+	long double last_sum;
+
+	if (r->exact)
+		return FALSE;
+
+	i = ++r->level;
+	for (set = 0; set < NUM_SETS; set++) {
+		if (!r->open[set])
+			continue;
+
+		if (i > TWZ_CALC_PREC + 2 || i >= NUM_POWERS) {
+			r->open[set] = FALSE;
+			continue;
+		}
+
+		last_sum = r->sum[set];
+		r->sum[set] += twz_v (r->x * r->powers[i], twz_w[set], NULL) / r->powers[i];
+		r->open[set] = (r->sum[set] == 0.0) || (r->sum[set] > last_sum);
+	}
+
+	refine_error (r);
+	return !r->exact;
+}
+
+
+
+/*--------------*/
+int twz_refine (long double x, int64_t wave_factor, long double tol, long double seconds, struct twz_refine *r)
+{
+	int64_t set, met;
+	long double deadline = seconds > 0 ? seconds_now () + seconds : 0.0;
+
+	if (!twz_refine_start (r, x, wave_factor))
+		return FALSE;
+
+	for (;;) {
+		for (set = 0, met = tol > 0; set < NUM_SETS; set++)
+			if (r->error[set] > tol)
+				met = FALSE;
+		if (r->exact || met || (deadline > 0 && seconds_now () >= deadline))
+			break;
+		twz_refine_next (r);
+	}
+
+	return TRUE;
+}
+
+
+
+/*  Every fine level still to come adds between 0 and max(w) / powers[i],
+ *  so the rest of the loop after level k adds between 0 and
+ *  max(w) / (powers[k] * (wf - 1)).  The estimate is the middle of that
+ *  range, padded for the rounding of the sums still to be done.
+ */
+/*--------------*/
+static void refine_error (struct twz_refine *r)
+{
+	int64_t set;
+	long double rest;
+
+	r->exact = TRUE;
+	for (set = 0; set < NUM_SETS; set++) {
+		if (!r->open[set]) {
+			r->value[set] = r->sum[set] / r->powers[3];
+			r->error[set] = 0.0;
+			continue;
+		}
+
+		r->exact = FALSE;
+		rest = w_max[set] / (r->powers[r->level] * (r->wave_factor - 1));
+		r->value[set] = (r->sum[set] + rest / 2) / r->powers[3];
+		r->error[set] = (rest / 2 + (r->sum[set] + rest) * LDBL_EPSILON * NUM_POWERS) / r->powers[3];
+	}
+}
+
+
+
+/*  Seconds on a monotonic clock  */
+/*--------------*/
+static long double seconds_now (void)
+{
+	struct timespec t;
+
+	clock_gettime (CLOCK_MONOTONIC, &t);
+	return t.tv_sec + t.tv_nsec * 1e-9L;
+}
+
+
+
+//  Range of every number set, once for all calls
+/*--------------*/
+static void set_w_range (void)
+{
+	int64_t i, set;
+
+	for (set = 0; set < NUM_SETS; set++) {
+		w_min[set] = w_max[set] = twz_w[set][0];
+		for (i = 1; i < NUM_DATA_POINTS; i++) {
+			if (twz_w[set][i] < w_min[set])
+				w_min[set] = twz_w[set][i];
+			if (twz_w[set][i] > w_max[set])
+				w_max[set] = twz_w[set][i];
+		}
+	}
+}
+
+
+
+/*  Coarse level i is active where x >= p[i]: it adds between 0 (or its
+ *  minimum, when it is active over the whole interval) and its maximum.
+ *  The fine loop adds every term up to the first one that is zero, so it
+ *  adds at least the minima of the terms up to the first whose minimum is
+ *  zero, and at most the sum of the maxima.  Once a level spans the whole
+ *  table, every finer one does too, and the rest of the series is bounded
+ *  by max(w) / (p[k-1] * (wf - 1)).
+ */
+/*--------------*/
+void twz_bound_set (long double a, long double b, int64_t number_set, const long double p[TWZ_POWERS],
+	long double *lo, long double *hi)
+{
+	int64_t i, lower_done = FALSE;
+	int64_t wave_factor = (int64_t) p[1];
+	long double l = 0.0, h = 0.0, vl, vh, pad;
+
+	pthread_once (&w_range_once, set_w_range);
+
+	for (i = 0; i < NUM_POWERS && b >= p[i]; i++) {
+		v_range (a / p[i], b / p[i], number_set, &vl, &vh);
+		h += vh * p[i];
+		if (a >= p[i])
+			l += vl * p[i];
+	}
+
+	for (i = 1; i < NUM_POWERS; i++) {
+		if ((b - a) * p[i] >= NUM_DATA_POINTS) {
+			h += w_max[number_set] / (p[i - 1] * (wave_factor - 1));
+			if (!lower_done)
+				l += w_min[number_set] / (p[i - 1] * (wave_factor - 1));
+			break;
+		}
+
+		v_range (a * p[i], b * p[i], number_set, &vl, &vh);
+		h += vh / p[i];
+		if (!lower_done) {
+			l += vl / p[i];
+			lower_done = (vl <= 0.0);
+		}
+	}
+
+	if (i == NUM_POWERS)
+		h += w_max[number_set] / (p[NUM_POWERS - 1] * (wave_factor - 1));
+
+	//  Allow for the rounding of the long double sums
+	pad = h * LDBL_EPSILON * 4 * NUM_POWERS;
+	*lo = (l - pad) / p[3];
+	*hi = (h + pad) / p[3];
+}
+
+
+
+//  Range of v() over [y0, y1]: the values at both ends and at every data point in between
+/*--------------*/
+static void v_range (long double y0, long double y1, int64_t number_set, long double *lo, long double *hi)
+{
+	long double n, y;
+
+	if (y1 - y0 >= NUM_DATA_POINTS || y0 > 1e18) {
+		*lo = w_min[number_set];
+		*hi = w_max[number_set];
+		return;
+	}
+
+	*lo = *hi = twz_v (y0, twz_w[number_set], NULL);
+	y = twz_v (y1, twz_w[number_set], NULL);
+	if (y < *lo)
+		*lo = y;
+	if (y > *hi)
+		*hi = y;
+
+	for (n = floorl (y0) + 1; n < y1; n++) {
+		y = twz_w[number_set][(int64_t) fmodl (n, NUM_DATA_POINTS)];
+		if (y < *lo)
+			*lo = y;
+		if (y > *hi)
+			*hi = y;
+	}
+}
+
@@ -0,0 +1,109 @@
+//  twz-bound.h
+//
+// Based on source code by the original author: Peter Meyer
+//  Guaranteed bounds on the timewave over an interval of dtz, without
+//  sampling it: every set's value anywhere in [a, b] lies between lo
+//  and hi.  And anytime evaluation at a point: a coarse estimate at
+//  once, refined one fine level at a time, each stage with a bound on
+//  its error, until a tolerance or a deadline is met.
+//
+//	long double lo[TWZ_SETS], hi[TWZ_SETS];
+//	struct twz_refine r;
+//
+//	if (twz_bound (0, 30, 64, lo, hi) && hi[TWZ_WATKINS] < 0.01)
+//		no_crossing ();
+//
+//	twz_refine (12.5, 64, 1e-12, 5e-6, &r);		//  within 1e-12 or 5 us
+//	use (r.value[TWZ_WATKINS], r.error[TWZ_WATKINS]);
+//
+//  Link with libtwz.a -lm.
+
+// Written for the Linux port
+// 19 Oct 2026
+
+/*
+
+This is free and unencumbered software released into the public domain.
+
+Anyone is free to copy, modify, publish, use, compile, sell, or
+distribute this software, either in source code form or as a compiled
+binary, for any purpose, commercial or non-commercial, and by any
+means.
+
+In jurisdictions that recognize copyright laws, the author or authors
+of this software dedicate any and all copyright interest in the
+software to the public domain. We make this dedication for the benefit
+of the public at large and to the detriment of our heirs and
+successors. We intend this dedication to be an overt act of
+relinquishment in perpetuity of all present and future rights to this
+software under copyright law.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+
+For more information, please refer to <http://unlicense.org/>
+
+09 Dec 2012
+*/
+
+#ifndef TWZ_BOUND_H
+#define TWZ_BOUND_H
+
+#include <stdint.h>
+
+#include "twz-stream.h"
+
+
+/*  Lower and upper bounds of every set over [a, b] days to zero, at the
+ *  given wave factor.  They hold for the values f() computes, the
+ *  truncation of its fine loop included, and are tighter the shorter the
+ *  interval.  Returns 0 (and leaves lo and hi alone) for an invalid wave
+ *  factor or interval: 0 <= a <= b, after the zero point the wave reads
+ *  past its number sets and has no bounds.  */
+int twz_bound (long double a, long double b, int64_t wave_factor, long double lo[TWZ_SETS], long double hi[TWZ_SETS]);
+
+/*  The same for one set, p the powers of the wave factor (twz_powers),
+ *  for callers that bound many intervals.  Nothing is checked: a and b
+ *  must satisfy 0 <= a <= b.  */
+void twz_bound_set (long double a, long double b, int64_t number_set, const long double p[TWZ_POWERS],
+	long double *lo, long double *hi);
+
+
+/*  The state of an anytime evaluation.  value and error are up to date
+ *  after every call: the value f() computes lies within error of value.
+ *  A set is exact once it has reached the end of f()'s fine loop; value
+ *  is then f()'s own result and error 0.
+ */
+struct twz_refine
+{
+	long double x;
+	int64_t wave_factor;
+	int64_t level;				//  fine levels added so far
+	int64_t exact;				//  every set has reached the end of the fine loop
+	long double value[TWZ_SETS];
+	long double error[TWZ_SETS];
+	long double sum[TWZ_SETS];	//  the sums of f(), before its final scaling
+	int64_t open[TWZ_SETS];
+	long double powers[TWZ_POWERS];
+};
+
+/*  Add the coarse levels at x (0 or more days before the zero point): the
+ *  first estimate.  Returns 0 for an invalid x or wave factor.  */
+int twz_refine_start (struct twz_refine *r, long double x, int64_t wave_factor);
+
+/*  Add the next fine level to every set not yet exact.  Returns 0 once
+ *  they all are.  */
+int twz_refine_next (struct twz_refine *r);
+
+/*  Start and refine until every error is at most tol or seconds have
+ *  passed (0 for no limit on either), whichever comes first; at least
+ *  the coarse estimate is made.  Returns 0 for an invalid x or wave
+ *  factor.  */
+int twz_refine (long double x, int64_t wave_factor, long double tol, long double seconds, struct twz_refine *r);
+
+#endif
@@ -0,0 +1,480 @@
+//  twz-explore.c
+//
+// Based on source code by the original authors: Peter Meyer, Matthew Watkins
+//  Screen many candidate hexagram sequences: derive the 384 data points
+//  of each candidate with Watkins' formula, evaluate the resulting wave
+//  over a window and print summary statistics, using multiple threads.
+
+// Written for the Linux port
+// 19 Oct 2026
+
+/*
+
+This is free and unencumbered software released into the public domain.
+
+Anyone is free to copy, modify, publish, use, compile, sell, or
+distribute this software, either in source code form or as a compiled
+binary, for any purpose, commercial or non-commercial, and by any
+means.
+
+In jurisdictions that recognize copyright laws, the author or authors
+of this software dedicate any and all copyright interest in the
+software to the public domain. We make this dedication for the benefit
+of the public at large and to the detriment of our heirs and
+successors. We intend this dedication to be an overt act of
+relinquishment in perpetuity of all present and future rights to this
+software under copyright law.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+
+For more information, please refer to <http://unlicense.org/>
+
+09 Dec 2012
+*/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <pthread.h>
+
+#include "twz-kernel.h"
+
+
+#define FALSE 0
+#define TRUE  1
+#define NUM_POWERS TWZ_POWERS
+#define PREC 16 // long double (80 bit) numbers have about 16 significant digits  INTEL / AMD / x86_64
+//#define PREC 32 // long double (128 bit) numbers have about 32 significant digits (QUAD PRECISION)
+#define NUM_DATA_POINTS TWZ_DATA_POINTS
+#define NUM_HEXAGRAMS 64
+#define MAX_THREADS 256
+#define ROUND_SIZE 4096		//  candidates held in memory per round
+
+
+#define MODE_PERM   0		//  random permutations of the King Wen differences
+#define MODE_RANDOM 1		//  random differences in 1..6
+#define MODE_FILE   2		//  64 differences per line, read from a file
+
+
+long double powers[NUM_POWERS];
+
+//  Powers of (normally) 64.
+//  Due to the limitations of double precision
+//  floating point arithmetic these values are
+//  exact only up to powers[8] for powers of 64.
+
+int64_t wave_factor = 64;		//  default wave factor
+
+
+char *usage = "\nUsage: twz-explore [mode] [count] [dtz] [neg] [step] [wf] [threads=nn] [seed=nn]."
+"\n mode = perm, random, or the name of a file with 64 differences per line"
+"\n count = number of candidates to generate (ignored when reading a file)"
+"\n dtz = days to zero-point"
+"\n neg = days to calculate into negative-time (past zero); the wave is only"
+"\n       defined before zero, so windows are cut off at the zero point"
+"\n step = steps in which to decrement time (in minutes)"
+"\n wf = wave factor (default 64, range 2-10000)"
+"\n threads = number of calculation threads (default: all processors)"
+"\n seed = seed for the perm and random modes (default 1)"
+"\n\nThis program screens candidate hexagram sequences: the 384 data points of each"
+"\ncandidate are derived with Watkins' formula and the resulting wave is evaluated"
+"\nwithin the given window.  One line of summary statistics is printed per candidate;"
+"\ncandidate 0 of the perm and random modes is the King Wen sequence itself.\n";
+
+
+char *title = "Candidate, Differences, Min, Max, Mean, Std Dev, Correlation with King Wen";
+
+
+//  The King Wen "first order of differences", h[1] .. h[64], h[0] = h[64]
+//  (see datapoints-watkins.c)
+int king_wen[NUM_HEXAGRAMS + 1] =
+{
+	3,
+	6, 2, 4, 4, 4, 3, 2, 4, 2, 4, 6, 2, 2, 4, 2, 2, 6, 3, 4, 3, 2, 2, 2, 3,
+	4, 2, 6, 2, 6, 3, 2, 3, 4, 4, 4, 2, 4, 6, 4, 3, 2, 4, 2, 3, 4, 3, 2, 3,
+	4, 4, 4, 1, 6, 2, 2, 3, 4, 3, 2, 1, 6, 3, 6, 3
+};
+
+
+//  One candidate and the statistics of its wave
+struct Candidate
+{
+	uint64_t id;
+	int h[NUM_HEXAGRAMS + 1];
+	long double min, max, mean, stddev, corr;
+};
+
+
+struct Candidate *round_buf;
+int64_t round_count;
+int64_t next_candidate;
+pthread_mutex_t next_lock = PTHREAD_MUTEX_INITIALIZER;
+
+long double *reference;			//  King Wen wave at every sample of the window
+long double ref_mean, ref_stddev;
+int64_t num_samples;
+
+long double dtzp, NegativeBailout, step;
+int64_t mode, count, num_threads;
+uint64_t seed = 1;
+
+
+void inputerror (void);
+void watkins (const int *h, int64_t *w);
+void make_candidate (struct Candidate *c);
+int read_candidate (FILE *in, struct Candidate *c);
+void evaluate (struct Candidate *c);
+void *worker (void *arg);
+uint64_t splitmix64 (uint64_t *state);
+
+int mod_64 (int i);
+int exp_minus_one (int i);
+
+
+/*-----------------------------*/
+int main (int argc, char *argv[])
+{
+	int64_t i, n, t;
+	int64_t kw[NUM_DATA_POINTS];
+	long double sum = 0.0, sum2 = 0.0;
+	FILE *in = NULL;
+	pthread_t threads[MAX_THREADS];
+	struct Candidate *c;
+
+	if (argc < 7) {
+		printf ("%s", usage);
+		inputerror ();
+	}
+
+	num_threads = sysconf (_SC_NPROCESSORS_ONLN);
+
+	for (i = 7; i < argc; i++) {
+		if (!memcmp (argv[i], "threads=", 8))
+			num_threads = atoi (&argv[i][8]);
+		else if (!memcmp (argv[i], "seed=", 5))
+			seed = strtoull (&argv[i][5], NULL, 10);
+		else {
+			printf ("%s", usage);
+			inputerror ();
+		}
+	}
+
+	if (num_threads < 1)
+		num_threads = 1;
+	if (num_threads > MAX_THREADS)
+		num_threads = MAX_THREADS;
+
+	if (!strcmp (argv[1], "perm"))
+		mode = MODE_PERM;
+	else if (!strcmp (argv[1], "random"))
+		mode = MODE_RANDOM;
+	else {
+		mode = MODE_FILE;
+		in = fopen (argv[1], "r");
+		if (in == NULL) {
+			printf ("%s", usage);
+			inputerror ();
+		}
+	}
+
+	count = atoll (&argv[2][0]);
+
+	dtzp = atof (&argv[3][0]);
+
+	NegativeBailout = atof (&argv[4][0]);
+	NegativeBailout *= -1;
+
+	step = atof (&argv[5][0]);
+	step /= 60;		// Convert to 60 minute hours
+	step /= 24;		// Convert to 24 hour days
+
+	wave_factor = atoi (&argv[6][0]);
+
+	// Windows that start after zero are refused below
+	if (NegativeBailout < 0.0) {
+		if (dtzp >= 0.0)
+			fprintf (stderr, "Screening from %.*Lf days to the zero point only\n", PREC, dtzp);
+		NegativeBailout = 0.0;
+	}
+
+	if (wave_factor < 2 || wave_factor > 10000 || step <= 0 || dtzp < NegativeBailout) {
+		printf ("%s", usage);
+		inputerror ();
+	}
+
+	twz_powers (powers, wave_factor);
+
+	// The King Wen wave is the reference every candidate is correlated against
+	num_samples = (int64_t) ((dtzp - NegativeBailout) / step) + 1;
+	reference = malloc (num_samples * sizeof (long double));
+	if (reference == NULL)
+		inputerror ();
+
+	// A sample that rounds to just past zero counts as zero: f() would
+	// index the data points below 0 there
+	watkins (king_wen, kw);
+	for (n = 0; n < num_samples; n++) {
+		reference[n] = twz_f (fmaxl (dtzp - n * step, 0.0), kw, powers);
+		sum += reference[n];
+		sum2 += reference[n] * reference[n];
+	}
+	ref_mean = sum / num_samples;
+	ref_stddev = sqrtl (fmaxl (sum2 / num_samples - ref_mean * ref_mean, 0.0));
+
+	round_buf = malloc (ROUND_SIZE * sizeof (struct Candidate));
+	if (round_buf == NULL)
+		inputerror ();
+
+	printf ("\n%s\n", title);
+
+	// Work through the candidates one round at a time so memory stays bounded
+	for (n = 0; mode == MODE_FILE || n < count; ) {
+		round_count = 0;
+		while (round_count < ROUND_SIZE && (mode == MODE_FILE || n < count)) {
+			c = &round_buf[round_count];
+			c->id = n;
+			if (mode == MODE_FILE) {
+				if (!read_candidate (in, c))
+					break;
+			} else
+				make_candidate (c);
+			round_count++;
+			n++;
+		}
+
+		if (round_count == 0)
+			break;
+
+		next_candidate = 0;
+		for (t = 0; t < num_threads; t++)
+			pthread_create (&threads[t], NULL, worker, NULL);
+		for (t = 0; t < num_threads; t++)
+			pthread_join (threads[t], NULL);
+
+		for (i = 0; i < round_count; i++) {
+			c = &round_buf[i];
+			printf ("%lu ,", c->id);
+			for (t = 1; t <= NUM_HEXAGRAMS; t++)
+				putchar ('0' + c->h[t]);
+			printf (" ,%.*Lf ,%.*Lf ,%.*Lf ,%.*Lf ,%.*Lf ,\n", PREC, c->min, PREC, c->max,
+				PREC, c->mean, PREC, c->stddev, PREC, c->corr);
+		}
+
+		if (round_count < ROUND_SIZE)
+			break;
+	}
+
+	if (in != NULL)
+		fclose (in);
+
+	return 0;
+}
+
+
+
+//  Calculation thread: take candidates from the current round until none are left
+/*--------------*/
+void *worker (void *arg)
+{
+	int64_t i;
+
+	for (;;) {
+		pthread_mutex_lock (&next_lock);
+		i = next_candidate++;
+		pthread_mutex_unlock (&next_lock);
+
+		if (i >= round_count)
+			break;
+
+		evaluate (&round_buf[i]);
+	}
+
+	return NULL;
+}
+
+
+
+//  Derive the data points of a candidate and summarize its wave over the window
+/*--------------*/
+void evaluate (struct Candidate *c)
+{
+	int64_t n;
+	int64_t w[NUM_DATA_POINTS];
+	long double y, sum = 0.0, sum2 = 0.0, cross = 0.0, var, cov;
+
+	watkins (c->h, w);
+
+	c->min = INFINITY;
+	c->max = -INFINITY;
+
+	for (n = 0; n < num_samples; n++) {
+		y = twz_f (fmaxl (dtzp - n * step, 0.0), w, powers);
+		if (y < c->min)
+			c->min = y;
+		if (y > c->max)
+			c->max = y;
+		sum += y;
+		sum2 += y * y;
+		cross += y * reference[n];
+	}
+
+	c->mean = sum / num_samples;
+	var = fmaxl (sum2 / num_samples - c->mean * c->mean, 0.0);
+	c->stddev = sqrtl (var);
+
+	cov = cross / num_samples - c->mean * ref_mean;
+	if (c->stddev > 0.0 && ref_stddev > 0.0)
+		c->corr = cov / (c->stddev * ref_stddev);
+	else
+		c->corr = 0.0;
+}
+
+
+
+//  Candidate c->id of the perm and random modes. Every candidate has its own
+//  generator state, so the output does not depend on the number of threads.
+/*--------------*/
+void make_candidate (struct Candidate *c)
+{
+	int64_t i, j, t;
+	uint64_t state = seed ^ (c->id * 0x9E3779B97F4A7C15ULL);
+
+	memcpy (c->h, king_wen, sizeof (king_wen));
+
+	if (c->id > 0) {
+		if (mode == MODE_PERM) {
+			for (i = NUM_HEXAGRAMS; i > 1; i--) {
+				j = 1 + splitmix64 (&state) % i;
+				t = c->h[i];
+				c->h[i] = c->h[j];
+				c->h[j] = t;
+			}
+		} else {
+			for (i = 1; i <= NUM_HEXAGRAMS; i++)
+				c->h[i] = 1 + splitmix64 (&state) % 6;
+		}
+	}
+
+	c->h[0] = c->h[NUM_HEXAGRAMS];
+}
+
+
+
+//  Read the next line of 64 differences (separated by blanks or commas, or
+//  written as 64 digits); blank lines and lines starting with '#' are skipped
+/*--------------*/
+int read_candidate (FILE *in, struct Candidate *c)
+{
+	char line[1024];
+	char *p;
+	int64_t i;
+
+	while (fgets (line, sizeof (line), in) != NULL) {
+		p = line;
+		while (*p == ' ' || *p == '\t')
+			p++;
+		if (*p == '#' || *p == '\n' || *p == '\r' || *p == 0)
+			continue;
+
+		for (i = 1; i <= NUM_HEXAGRAMS && *p; ) {
+			if (*p >= '0' && *p <= '9')
+				c->h[i++] = *p - '0';
+			else if (*p != ' ' && *p != ',' && *p != '\t')
+				break;
+			p++;
+		}
+
+		if (i <= NUM_HEXAGRAMS) {
+			fprintf (stderr, "Skipping line: expected %d differences\n", NUM_HEXAGRAMS);
+			continue;
+		}
+
+		c->h[0] = c->h[NUM_HEXAGRAMS];
+		return TRUE;
+	}
+
+	return FALSE;
+}
+
+
+
+//  Watkins' formula for the 384 data points, as in datapoints-watkins.c.
+//  The "b" term there ends in a comma operator, which drops its 6 * (...)
+//  part; it is left out here as well so both programs agree.
+/*--------------*/
+void watkins (const int *h, int64_t *w)
+{
+	int k, a, b;
+
+	for (k = 0; k < NUM_DATA_POINTS; k++) {
+		a = (exp_minus_one ((k - 1) / 32))
+			* (h[mod_64 (k - 1)] - h[mod_64 (k - 2)]
+			+ h[mod_64 (-k)] - h[mod_64 (1 - k)])
+			+ 3 * ((exp_minus_one ((k - 3) / 96))
+			* (h[mod_64 ((k / 3) - 1)]
+			- h[mod_64 ((k / 3) - 2)]
+			+ h[mod_64 (-1 * (k / 3))]
+			- h[mod_64 (1 - (k / 3))]))
+			+ 6 * ((exp_minus_one ((k - 6) / 192))
+			* (h[mod_64 ((k / 6) - 1)]
+			- h[mod_64 ((k / 6) - 2)]
+			+ h[mod_64 (-1 * (k / 6))]
+			- h[mod_64 (1 - (k / 6))]));
+
+		b = (9 - h[mod_64 (-k)] - h[mod_64 (k - 1)])
+			+ 3 * (9 - h[mod_64 (-1 * (k / 3))] - h[mod_64 ((k / 3) - 1)]);
+
+		w[k] = abs (a) + abs (b);
+	}
+}
+
+
+
+/*-------------*/
+int mod_64 (int i)
+{
+	while (i < 0)
+		i += 64;
+
+	return (i % 64);
+}
+
+/*--------------------*/
+int exp_minus_one (int i)
+{
+	if (i < 0)
+		i *= -1;
+
+	return (i % 2 ? -1 : 1);
+}
+
+
+
+//  Small, fast generator for the perm and random modes
+/*--------------*/
+uint64_t splitmix64 (uint64_t *state)
+{
+	uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	return z ^ (z >> 31);
+}
+
+
+
+void inputerror (void)
+{
+	printf ("\nError: Invalid input, exiting.\n\n");
+	exit (EXIT_SUCCESS);
+}
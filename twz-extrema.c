@@ -0,0 +1,375 @@
+//  twz-extrema.c
+//
+// Based on source code by the original author: Peter Meyer
+//  Find the deepest minima and highest maxima of the timewave within a
+//  window by branch-and-bound on interval bounds of f(), using one
+//  thread per number set and kind of extremum.
+
+// Written for the Linux port
+// 19 Oct 2026
+
+/*
+
+This is free and unencumbered software released into the public domain.
+
+Anyone is free to copy, modify, publish, use, compile, sell, or
+distribute this software, either in source code form or as a compiled
+binary, for any purpose, commercial or non-commercial, and by any
+means.
+
+In jurisdictions that recognize copyright laws, the author or authors
+of this software dedicate any and all copyright interest in the
+software to the public domain. We make this dedication for the benefit
+of the public at large and to the detriment of our heirs and
+successors. We intend this dedication to be an overt act of
+relinquishment in perpetuity of all present and future rights to this
+software under copyright law.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+
+For more information, please refer to <http://unlicense.org/>
+
+09 Dec 2012
+*/
+
+#include <math.h>
+#include <float.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <pthread.h>
+
+#include "twz-bound.h"
+
+
+#define FALSE 0
+#define TRUE  1
+#define PREC 16 // long double (80 bit) numbers have about 16 significant digits  INTEL / AMD / x86_64
+//#define PREC 32 // long double (128 bit) numbers have about 32 significant digits (QUAD PRECISION)
+#define NUM_SETS TWZ_SETS
+#define MAX_RANK 1000
+
+
+long double powers[TWZ_POWERS];
+
+//  Powers of (normally) 64.
+//  Due to the limitations of double precision
+//  floating point arithmetic these values are
+//  exact only up to powers[8] for powers of 64.
+
+int64_t wave_factor = 64;		//  default wave factor
+
+
+char *usage = "\nUsage: twz-extrema [dtz] [neg] [wf] [k] [tol=nn] [sep=nn] [res=nn]."
+"\n dtz = days to zero-point"
+"\n neg = days to search into negative-time (past zero)"
+"\n wf = wave factor (default 64, range 2-10000)"
+"\n k = number of minima and of maxima to find per number set"
+"\n tol = precision of the values found (default: 1e-9 of the range of the wave)"
+"\n sep = least distance between two extrema, in days (default: 1/100 of the window)"
+"\n res = narrowest interval that is split further, in minutes (default 1e-6)"
+"\n\nThis program finds the k lowest minima and k highest maxima of every number set"
+"\nwithin the given window, without sampling the whole window.  Only the part of the"
+"\nwindow before the zero point (dtz > 0) is searched.\n";
+
+
+char *set_name[NUM_SETS] =
+{ "Kelley", "Watkins", "Sheliak", "Huang Ti" };
+
+
+char *title = "Set, Extremum, Rank, Days to Zero (DTZ), Value, Bound, Evaluations";
+
+
+//  A sub-window still to be searched, with the bound of the wave over it
+//  (a lower bound when searching for minima, the negated upper bound for maxima)
+struct Node
+{
+	long double a, b, bound;
+};
+
+//  One search: a number set and a kind of extremum
+struct Search
+{
+	int64_t number_set;
+	int64_t maxima;
+	int64_t found;
+	long double x[MAX_RANK], value[MAX_RANK], bound[MAX_RANK];
+	int64_t evaluations[MAX_RANK];
+	struct Node *heap;
+	int64_t heap_size, heap_alloc;
+};
+
+struct Search searches[NUM_SETS][2];
+
+long double window_a, window_b, tolerance = 0.0, separation = 0.0, resolution;
+int64_t rank;
+
+
+void inputerror (void);
+void *search (void *arg);
+long double node_bound (struct Search *s, long double a, long double b);
+long double sample (struct Search *s, long double x);
+int excluded (struct Search *s, long double a, long double b);
+void push (struct Search *s, long double a, long double b, long double bound);
+struct Node pop (struct Search *s);
+
+
+/*-----------------------------*/
+int main (int argc, char *argv[])
+{
+	int64_t i, j, number_set, maxima;
+	long double lo, hi, range = 0.0;
+	pthread_t threads[NUM_SETS][2];
+	struct Search *s;
+
+	if (argc < 5) {
+		printf ("%s", usage);
+		inputerror ();
+	}
+
+	window_b = atof (&argv[1][0]);
+	window_a = -atof (&argv[2][0]);
+	wave_factor = atoi (&argv[3][0]);
+	rank = atoi (&argv[4][0]);
+	resolution = 1e-6;
+
+	for (i = 5; i < argc; i++) {
+		if (!memcmp (argv[i], "tol=", 4))
+			tolerance = atof (&argv[i][4]);
+		else if (!memcmp (argv[i], "sep=", 4))
+			separation = atof (&argv[i][4]);
+		else if (!memcmp (argv[i], "res=", 4))
+			resolution = atof (&argv[i][4]);
+		else {
+			printf ("%s", usage);
+			inputerror ();
+		}
+	}
+
+	if (wave_factor < 2 || wave_factor > 10000 || rank < 1 || rank > MAX_RANK
+		|| window_b <= 0.0 || window_a >= window_b || tolerance < 0.0 || separation < 0.0
+		|| resolution <= 0.0) {
+		printf ("%s", usage);
+		inputerror ();
+	}
+
+	if (window_a < 0.0) {
+		fprintf (stderr, "Searching from the zero point to %.*Lf days only\n", PREC, window_b);
+		window_a = 0.0;
+	}
+
+	resolution /= 60 * 24;		// Convert minutes to days
+	if (separation == 0.0)
+		separation = (window_b - window_a) / 100;
+
+	twz_powers (powers, wave_factor);
+
+	for (number_set = 0; number_set < NUM_SETS; number_set++) {
+		twz_bound_set (window_a, window_b, number_set, powers, &lo, &hi);
+		if (hi - lo > range)
+			range = hi - lo;
+	}
+
+	if (tolerance == 0.0)
+		tolerance = range * 1e-9;
+
+	for (number_set = 0; number_set < NUM_SETS; number_set++)
+		for (maxima = 0; maxima < 2; maxima++) {
+			s = &searches[number_set][maxima];
+			s->number_set = number_set;
+			s->maxima = maxima;
+			pthread_create (&threads[number_set][maxima], NULL, search, s);
+		}
+
+	printf ("\n%s\n", title);
+
+	for (number_set = 0; number_set < NUM_SETS; number_set++)
+		for (maxima = 0; maxima < 2; maxima++) {
+			pthread_join (threads[number_set][maxima], NULL);
+			s = &searches[number_set][maxima];
+
+			for (j = 0; j < s->found; j++)
+				printf ("%s ,%s ,%ld ,%.*Lf ,%.*Lf ,%.*Lf ,%ld ,\n", set_name[number_set],
+					maxima ? "max" : "min", j + 1, PREC, s->x[j], PREC, s->value[j],
+					PREC, s->bound[j], s->evaluations[j]);
+		}
+
+	fprintf (stderr, "A dense scan at the resolution would take %.0Lf samples per set\n",
+		(window_b - window_a) / resolution + 1);
+
+	return 0;
+}
+
+
+
+/*  Best-first branch-and-bound for the k best extrema of one set.
+ *  Maxima are found as minima of -f().  The sub-window with the lowest
+ *  bound is split first; sub-windows whose bound cannot beat the best
+ *  value seen by more than the tolerance are dropped.  After each
+ *  extremum a zone of +/- sep around it is excluded and the search runs
+ *  again; the bound reported is the lowest bound left when it stopped,
+ *  so the true extremum outside the excluded zones lies between it and
+ *  the value.
+ */
+/*--------------*/
+void *search (void *arg)
+{
+	struct Search *s = (struct Search *) arg;
+	struct Node n;
+	long double best, best_x, y, m;
+	int64_t evaluations;
+
+	while (s->found < rank) {
+		s->heap_size = 0;
+		evaluations = 0;
+		best = INFINITY;
+		best_x = window_b;
+
+		if (!excluded (s, window_a, window_a)) {
+			best = sample (s, window_a);
+			best_x = window_a;
+		}
+		if (!excluded (s, window_b, window_b) && (y = sample (s, window_b)) < best) {
+			best = y;
+			best_x = window_b;
+		}
+		evaluations += 2;
+
+		push (s, window_a, window_b, node_bound (s, window_a, window_b));
+
+		while (s->heap_size > 0) {
+			if (s->heap[0].bound >= best - tolerance)
+				break;
+
+			n = pop (s);
+			if (excluded (s, n.a, n.b))
+				continue;
+
+			m = n.a + (n.b - n.a) / 2;
+			if (!excluded (s, m, m)) {
+				y = sample (s, m);
+				evaluations++;
+				if (y < best) {
+					best = y;
+					best_x = m;
+				}
+			}
+
+			if (n.b - n.a < resolution)
+				continue;
+
+			push (s, n.a, m, node_bound (s, n.a, m));
+			push (s, m, n.b, node_bound (s, m, n.b));
+		}
+
+		if (best == INFINITY)
+			break;		//  the whole window is excluded
+
+		s->x[s->found] = best_x;
+		s->value[s->found] = s->maxima ? -best : best;
+		y = s->heap_size > 0 && s->heap[0].bound < best ? s->heap[0].bound : best;
+		s->bound[s->found] = s->maxima ? -y : y;
+		s->evaluations[s->found] = evaluations;
+		s->found++;
+	}
+
+	free (s->heap);
+	return NULL;
+}
+
+
+
+/*--------------*/
+long double sample (struct Search *s, long double x)
+{
+	long double y = twz_f (x, twz_w[s->number_set], powers);
+
+	return s->maxima ? -y : y;
+}
+
+
+
+/*--------------*/
+long double node_bound (struct Search *s, long double a, long double b)
+{
+	long double lo, hi;
+
+	twz_bound_set (a, b, s->number_set, powers, &lo, &hi);
+	return s->maxima ? -hi : lo;
+}
+
+
+
+//  TRUE when [a, b] lies within the excluded zone of an extremum already found
+/*--------------*/
+int excluded (struct Search *s, long double a, long double b)
+{
+	int64_t j;
+
+	for (j = 0; j < s->found; j++)
+		if (a >= s->x[j] - separation && b <= s->x[j] + separation)
+			return TRUE;
+
+	return FALSE;
+}
+
+
+
+//  Binary heap of nodes, lowest bound first
+/*--------------*/
+void push (struct Search *s, long double a, long double b, long double bound)
+{
+	int64_t i, parent;
+	struct Node n = { a, b, bound };
+
+	if (s->heap_size == s->heap_alloc) {
+		s->heap_alloc = s->heap_alloc ? 2 * s->heap_alloc : 1024;
+		s->heap = realloc (s->heap, s->heap_alloc * sizeof (struct Node));
+		if (s->heap == NULL)
+			inputerror ();
+	}
+
+	for (i = s->heap_size++; i > 0; i = parent) {
+		parent = (i - 1) / 2;
+		if (s->heap[parent].bound <= bound)
+			break;
+		s->heap[i] = s->heap[parent];
+	}
+	s->heap[i] = n;
+}
+
+
+
+/*--------------*/
+struct Node pop (struct Search *s)
+{
+	int64_t i, child;
+	struct Node top = s->heap[0], last = s->heap[--s->heap_size];
+
+	for (i = 0; (child = 2 * i + 1) < s->heap_size; i = child) {
+		if (child + 1 < s->heap_size && s->heap[child + 1].bound < s->heap[child].bound)
+			child++;
+		if (last.bound <= s->heap[child].bound)
+			break;
+		s->heap[i] = s->heap[child];
+	}
+	s->heap[i] = last;
+
+	return top;
+}
+
+
+
+void inputerror (void)
+{
+	printf ("\nError: Invalid input, exiting.\n\n");
+	exit (EXIT_SUCCESS);
+}
@@ -19,6 +19,9 @@
 // John A Phelps
 // kl4yfd@gmail.com
 
+// Reworked into a planned pool of chunk workers with ordered output
+// 19 Oct 2026
+
 /*
 
 This is free and unencumbered software released into the public domain.
@@ -50,6 +53,7 @@ For more information, please refer to <http://unlicense.org/>
 */
 
 #include <math.h>
+#include <float.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
@@ -57,39 +61,108 @@ For more information, please refer to <http://unlicense.org/>
 
 #include <stdbool.h>
 #include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <signal.h>
+#include <semaphore.h>
 
+#include "twz-levels.h"
 
 #define FALSE 0
 #define TRUE  1
-#define NUM_POWERS 64
+#define NUM_POWERS TWZ_POWERS
 #define PREC 16 // long double (80 bit) numbers have about 16 significant digits  INTEL / AMD / x86_64
 //#define PREC 32 // long double (128 bit) numbers have about 32 significant digits (QUAD PRECISION)
-#define NUM_SETS 4
-#define NUM_DATA_POINTS 384
-#define CALC_PREC       1000000  //  precision in calculation of wave values
+#define NUM_SETS TWZ_SETS
+#define NUM_DATA_POINTS TWZ_DATA_POINTS
+#define ALWAYS_INLINE static inline __attribute__ ((always_inline))
+#define MAX_THREADS 256
+#define MIN_CHUNK 64			//  samples a worker takes at a time
+#define MAX_CHUNK 65536
+#define MODEL_POINTS 1024		//  samples the cost model averages over
+#define PROBE_POINTS 1024		//  samples timed to calibrate the cost model
+#define ENGINE_EXACT 0
+#define ENGINE_INCREMENTAL 1
+#define ENGINE_INTEGRAL 2
+#define ENGINE_FOLD 3
+#define MAX_FOLD_NODES (1 << 21)	//  largest base-octave table (64 MB)
+#define MAX_BINS 1000
+#define FIELD_WIDTH 24			//  characters per value with file= (%24.16Le)
+#define STATS_EVERY 10			//  default seconds between rewrites of stats=
+#define MAX_SPECTRUM (1 << 20)	//  longest spectrum= block
+
+
+
+/*  What the planner decided for this run.  Fields given on the command
+ *  line are kept, the rest come from the cost model (see make_plan).
+ */
+struct Plan 
+{
+	int64_t samples;
+	int64_t threads;
+	int64_t chunk;
+	int64_t engine;				//  -1 until chosen
+	long double iterations;		//  expected coarse + fine iterations per value
+	long double seconds;		//  expected run time
+};
 
+/*  Running statistics of a stretch of samples (reduce mode).  The means
+ *  and the co-moments c[a][b] = sum (x_a - mean_a)(x_b - mean_b) are
+ *  updated one sample at a time (Welford), and two stretches merge exactly
+ *  (Chan et al.), so the workers reduce their chunks and the main thread
+ *  combines them in order.
+ */
+struct Stats 
+{
+	int64_t n;
+	long double min[NUM_SETS], max[NUM_SETS];
+	long double min_at[NUM_SETS], max_at[NUM_SETS];	//  dtz of the first minimum and maximum
+	long double mean[NUM_SETS];
+	long double c[NUM_SETS][NUM_SETS];
+	int64_t hist[NUM_SETS][MAX_BINS + 2];	//  below hist_lo, the bins, from hist_hi up
+};
 
+/*  Binary output (out=bin), the format of twz-sweep with a single row:
+ *    header    (the struct below, 56 bytes)
+ *    int64_t   the wave factor
+ *    double    values[samples][sets]
+ */
+struct BinaryHeader 
+{
+	char magic[8];				//  "TWZBIN2"
+	int64_t rows, cols, sets;
+	double start, step;
+	int64_t mask;				//  sets present, bit n for set n
+};
 
-struct ThreadStruct 
+/*  Workers fill chunks in any order; the main thread prints them (or merges
+ *  their statistics) in order and then hands the slot on to chunk index +
+ *  num_slots.
+ */
+struct Slot 
 {
-	volatile bool _lock1;
-	volatile bool _lock2;
-	volatile bool _lock3;
-	volatile bool _lock4;
-  
-	volatile long double x1;
-	volatile long double x2;
-	volatile long double x3;
-	volatile long double x4;
-	
-	volatile long double ans1;
-	volatile long double ans2;
-	volatile long double ans3;
-	volatile long double ans4;
+	int64_t index;				//  chunk ready in the slot, -1 while it is filled
+	long double (*ans)[NUM_SETS];
+	long double (*slope)[NUM_SETS];
+	struct Stats *stats;		//  reduce mode
+	double (*power)[NUM_SETS];	//  spectrum mode: |X(k)|^2 of each block of the chunk, one after the other
+	int64_t blocks;
 };
 
-/// Create a global lock structure to ease programming (4 static threads, so this is OK)
-struct ThreadStruct lockstruct;
+/*  Progress of one worker.  Each worker stores its own counters with
+ *  relaxed atomics once per chunk, so the hot loops are untouched, and the
+ *  monitor thread reads them all whenever it reports.  One cache line per
+ *  worker, so they do not share one.
+ */
+struct Telemetry 
+{
+	int64_t samples;			//  samples done
+	int64_t current;			//  first sample of the chunk in hand, -1 when idle
+	int64_t bytes;				//  bytes written (file=)
+	int64_t busy_ns;			//  time spent computing and writing its chunks
+} __attribute__ ((aligned (64)));
 
 long double NegativeBailout = -2.0;
 long double powers[NUM_POWERS];
@@ -103,11 +176,119 @@ int64_t wave_factor = 64;		//  default wave factor
 int64_t number_set, stringchar;
 
 
-char *usage = "\nUsage: twz [dtz] [neg] [step] [wf]." 
+char *engine_name[4] = { "exact", "incremental", "integral", "fold" };
+
+struct Plan plan;
+struct Slot *slots;
+int64_t num_slots, num_chunks, next_chunk, printed_chunks;
+int64_t want_slope = FALSE;
+
+//  Reduce mode: print only the statistics of the window, with a histogram
+//  of hist_bins bins from hist_lo to hist_hi when hist_bins is not 0
+int64_t want_reduce = FALSE, hist_bins = 0, want_binary = FALSE;
+long double hist_lo, hist_hi;
+
+//  Fixed-width text (file=): every value takes FIELD_WIDTH characters and
+//  a separator, so row n starts at header_bytes + n * row_bytes and the
+//  workers write their chunks straight into the file, in any order
+char *out_path = NULL;
+int out_fd = -1;
+int64_t header_bytes, row_bytes;
+
+//  Welch power spectra (spectrum=n): Hann-windowed blocks of n samples
+//  every n/2, their mean removed, averaged over the window
+int64_t spectrum_n = 0;
+double *hann, hann_power;		//  the window and the sum of its squares
+double *twiddle_re, *twiddle_im;
+
+//  Telemetry: kill -USR1 prints a progress report on stderr, stats= also
+//  rewrites it in a file every stats_every seconds
+struct Telemetry telemetry[MAX_THREADS];
+int64_t printed_bytes = 0;		//  written by the main thread
+char *stats_path = NULL;
+long double stats_every = STATS_EVERY;
+long double run_start;
+sem_t monitor_wake;
+int64_t monitor_done = FALSE;
+pthread_t monitor_thread;
+
+//  Integral mode: each sample is the integral (or the mean) of the wave
+//  over the window of this many days centred on it
+long double window = 0.0;
+int64_t want_average = FALSE;
+
+//  w_prefix[set][n] is the integral of v() from 0 to n, and w_max[set] the
+//  largest value in the set
+long double w_prefix[NUM_SETS][NUM_DATA_POINTS + 1];
+long double w_max[NUM_SETS];
+
+/*  Octave folding: without its truncation f(x*wf) = wf*f(x), so a sample
+ *  x = wf^k * u with u in [1, wf) is wf^k times the wave at u.  fold_value
+ *  holds f() on the base octave at spacing fold_h = wf^-fold_levels, filled
+ *  in as samples need it.  Linear interpolation between the nodes is exact
+ *  for every level down to that spacing, so only the finer levels, at most
+ *  w_max/(wf^fold_levels*(wf-1)) at u, are interpolated away.
+ */
+long double fold_tol = 0.0;
+int64_t fold_levels, fold_nodes;
+long double fold_h, fold_bound;
+double (*fold_value)[NUM_SETS];
+char *fold_ready;
+
+/*  Log sampling: log_per_octave samples per octave (factor wf) of dtz, from
+ *  dtz down to step before zero, zero itself, and from step up to neg after
+ *  it.  log_base[0][r] and log_base[1][r] are sample r of the first octave
+ *  on each side; the others are these divided (before zero) or multiplied
+ *  (after zero) by powers of the wave factor, so every octave holds the
+ *  same points of the wave scaled.  With fold= the full series at the
+ *  samples of the first octave before zero serves all the others.
+ */
+int64_t log_per_octave = 0;
+int64_t log_before, log_zero, log_after;
+long double *log_base[2];
+long double (*log_value)[NUM_SETS];
+pthread_mutex_t pool_lock = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t slot_free = PTHREAD_COND_INITIALIZER;
+pthread_cond_t chunk_done = PTHREAD_COND_INITIALIZER;
+
+
+char *usage = "\nUsage: twz [dtz] [neg] [step] [wf] [options]." 
 "\n dtz = days to zero-point" 
 "\n neg = days to calcualte into negative-time (past zero)" 
 "\n step = steps in which to decrement time (in minutes)" 
 "\n wf = wave factor (default 64, range 2-10000)" 
+"\n\nOptions (the planner picks whatever is not given):"
+"\n threads=n = number of calculation threads"
+"\n chunk=n = samples a thread takes at a time"
+"\n engine=exact = evaluate every sample on its own"
+"\n engine=incremental = share the coarse levels between consecutive samples"
+"\n                      (may differ from exact in the last digit)"
+"\n budget=s = ask before running a job estimated to take over s seconds"
+"\n            (default 600); refuse it when there is nobody to ask"
+"\n yes = run the job whatever its estimate"
+"\n plan = print the plan and estimate, then exit"
+"\n slope = also print the slope of each set (per day of dtz) of the levels"
+"\n         f() adds up; it leaves out the finer ones (see README)"
+"\n average=m = print the exact mean of each set over the m minutes centred"
+"\n             on each sample instead of its value"
+"\n integral=m = the same with the integral (in days) instead of the mean"
+"\n fold=tol = reuse one octave of the wave for the others, within tol of the"
+"\n            scale x*max(w)/wf^3 of the wave (e.g. 1e-6)"
+"\n reduce = print only the minimum, maximum, mean and variance of each set"
+"\n          and the correlations between them, not the samples"
+"\n hist=n,lo,hi = reduce, with a histogram of n bins from lo to hi"
+"\n out=bin = write the samples as binary doubles (see README), not text"
+"\n file=path = write fixed-width rows (%24.16Le) to the file, every thread"
+"\n             writing its own chunks in place"
+"\n log=n = n samples per octave (factor wf) of dtz instead of one per step,"
+"\n         on both sides of zero; step is then the closest they come to it"
+"\n spectrum=n = print only the power spectral density of each set, averaged"
+"\n              over Hann-windowed blocks of n samples (a power of 2) that"
+"\n              overlap by half (Welch)"
+"\n sets=list = calculate and write only the number sets listed, e.g. 1,3 for"
+"\n             Kelley and Sheliak (default all)"
+"\n stats=path[,s] = rewrite a progress report in path every s seconds"
+"\n                  (default 10); kill -USR1 prints it on stderr at any time"
 "\n\nThis program calculates the running values of the timewave within the given window.\n";
 
 
@@ -116,55 +297,83 @@ char *set_name[NUM_SETS] =
 { "Kelley", "Watkins", "Sheliak", "Huang Ti" };
 
 
-char *title = "Days to Zero (DTZ), Kelley, Watkins, Sheliak, Huang Ti";
-
-
-//  The number sets.
-int64_t w[NUM_SETS][NUM_DATA_POINTS] = 
-{ 
-	{
-	#include "DATA/DATA.TW1"		//  half-twist
-	}, 
-	{
-	#include "DATA/DATA.TW2"		//  no half-twist
-	}, 
-	{
-	#include "DATA/DATA.TW3"		//  Sheliak 
-	}, 
-	{
-	#include "DATA/DATA.TW4"		//  HuangTi (no half-twist)
-	} 
-};
+/*  Column projection: only the sets in set_mask (sets=, all by default)
+ *  are calculated, reduced and written, in their usual order.  The titles
+ *  name just those; set_list is their part of the title (", Kelley, ...").
+ */
+int64_t set_mask = (1 << NUM_SETS) - 1;
+int64_t num_selected = NUM_SETS;
+char set_list[128], title[256], slope_title[256];
+
 
 void inputerror (void);
 void get_dtzp (void);
 void get_NegBailout (void);
 void get_step (void);
 void get_wave_factor (void);
-void set_powers (void);
-long double f (long double x, int64_t number_set);
-void *fONE (void);
-void *fTWO (void);
-void *fTHREE (void);
-void *fFOUR (void);
-
-long double v (long double y, int64_t number_set);
-long double mult_power (long double x, int64_t i);
-long double div_power (long double x, int64_t i);
+int64_t parse_sets (char *s);
+void set_columns (void);
+void set_prefix (void);
+void set_fold (void);
+void report_fold (void);
+int64_t fold_octave (long double x, long double *u);
+int64_t f_fold (int64_t n, long double *ans);
+void set_samples (void);
+void stats_clear (struct Stats *s);
+void stats_add (struct Stats *s, long double x, long double *ans);
+void stats_print (struct Stats *s);
+void stats_merge (struct Stats *s, struct Stats *t);
+long double fold_series (long double x, int64_t number_set);
+void make_plan (struct Plan *p);
+long double iterations (long double x, long double *shared);
+long double now (void);
+int64_t doublecheck (long double budget);
+void *worker (void *arg);
+void compute_chunk (int64_t first, int64_t last, long double (*ans)[NUM_SETS], long double (*slope)[NUM_SETS], 
+	struct twz_levels *cache);
+void open_fixed (void);
+void write_chunk (int64_t first, int64_t last, long double (*ans)[NUM_SETS], long double (*slope)[NUM_SETS], char *text);
+int64_t format_field (char *p, long double value);
+void start_monitor (void);
+void stop_monitor (void);
+void *monitor (void *arg);
+void on_usr1 (int sig);
+void report (FILE *out);
+void set_spectrum (void);
+void fft (double *re, double *im);
+void spectrum_chunk (int64_t first, int64_t last, struct Slot *s, double *re, double *im);
+void spectrum_print (double (*power)[NUM_SETS], int64_t blocks);
+long double sample_dtz (int64_t n);
+long double f_integral (long double a, long double b, int64_t number_set);
+ALWAYS_INLINE long double v_integral (long double ya, long double yb, int64_t number_set);
+ALWAYS_INLINE long double v_prefix (long double y, int64_t number_set);
+
+ALWAYS_INLINE long double mult_power (long double x, int64_t i);
+ALWAYS_INLINE long double div_power (long double x, int64_t i);
 long double dtzp, step;
 
 
 /*-----------------------------*/ 
 int main (int argc, char *argv[]) 
 {
-	int64_t i, j, ch;
-
-	if (argc != 5 && argc != 1) {
+	int64_t i, k, c, n, first, last, confirmed = FALSE, plan_only = FALSE, bytes = 0, blocks = 0;
+	long double budget = 600;
+	pthread_t thread[MAX_THREADS];
+	struct Slot *s;
+	struct Stats *total = NULL;
+	double (*power)[NUM_SETS] = NULL;
+	struct BinaryHeader header;
+	double row[NUM_SETS];
+
+	if (argc < 5 && argc != 1) {
 		printf ("%s", usage);
 		inputerror ();
 	}
   
-	if (argc == 5) {
+	plan.threads = plan.chunk = 0;
+	plan.engine = -1;
+
+	if (argc >= 5) {
 		dtzp = atof (&argv[1][0]);
 		NegativeBailout = atof (&argv[2][0]);
 		NegativeBailout *= -1;
@@ -179,6 +388,77 @@ int main (int argc, char *argv[])
 			printf ("%s", usage);
 			inputerror ();
 	    }
+
+		for (i = 5; i < argc; i++) {
+			if (!memcmp (argv[i], "threads=", 8)) {
+				plan.threads = atoi (&argv[i][8]);
+				if (plan.threads < 1 || plan.threads > MAX_THREADS)
+					inputerror ();
+			} else if (!memcmp (argv[i], "chunk=", 6)) {
+				plan.chunk = atol (&argv[i][6]);
+				if (plan.chunk < 1 || plan.chunk > MAX_CHUNK)
+					inputerror ();
+			} else if (!strcmp (argv[i], "engine=exact")) {
+				plan.engine = ENGINE_EXACT;
+			} else if (!strcmp (argv[i], "engine=incremental")) {
+				plan.engine = ENGINE_INCREMENTAL;
+			} else if (!memcmp (argv[i], "budget=", 7)) {
+				budget = atof (&argv[i][7]);
+				if (budget <= 0)
+					inputerror ();
+			} else if (!strcmp (argv[i], "yes")) {
+				confirmed = TRUE;
+			} else if (!strcmp (argv[i], "plan")) {
+				plan_only = TRUE;
+			} else if (!strcmp (argv[i], "slope")) {
+				want_slope = TRUE;
+			} else if (!memcmp (argv[i], "fold=", 5)) {
+				fold_tol = atof (&argv[i][5]);
+				if (fold_tol <= 0)
+					inputerror ();
+			} else if (!memcmp (argv[i], "file=", 5)) {
+				out_path = &argv[i][5];
+				if (!*out_path)
+					inputerror ();
+			} else if (!memcmp (argv[i], "spectrum=", 9)) {
+				spectrum_n = atol (&argv[i][9]);
+				if (spectrum_n < 4 || spectrum_n > MAX_SPECTRUM || (spectrum_n & (spectrum_n - 1)))
+					inputerror ();
+			} else if (!memcmp (argv[i], "sets=", 5)) {
+				set_mask = parse_sets (&argv[i][5]);
+				if (!set_mask)
+					inputerror ();
+			} else if (!memcmp (argv[i], "stats=", 6)) {
+				stats_path = &argv[i][6];
+				if (strchr (stats_path, ',')) {
+					stats_every = atof (strchr (stats_path, ',') + 1);
+					*strchr (stats_path, ',') = '\0';
+				}
+				if (!*stats_path || stats_every <= 0)
+					inputerror ();
+			} else if (!strcmp (argv[i], "out=bin")) {
+				want_binary = TRUE;
+			} else if (!strcmp (argv[i], "reduce")) {
+				want_reduce = TRUE;
+			} else if (!memcmp (argv[i], "hist=", 5)) {
+				want_reduce = TRUE;
+				if (sscanf (&argv[i][5], "%ld,%Lf,%Lf", &hist_bins, &hist_lo, &hist_hi) != 3 
+					|| hist_bins < 1 || hist_bins > MAX_BINS || hist_hi <= hist_lo)
+					inputerror ();
+			} else if (!memcmp (argv[i], "log=", 4)) {
+				log_per_octave = atol (&argv[i][4]);
+				if (log_per_octave < 1 || log_per_octave > MAX_CHUNK)
+					inputerror ();
+			} else if (!memcmp (argv[i], "average=", 8) || !memcmp (argv[i], "integral=", 9)) {
+				want_average = argv[i][0] == 'a';
+				window = atof (strchr (argv[i], '=') + 1) / 60 / 24;
+				if (window <= 0)
+					inputerror ();
+			} else {
+				printf ("%s", usage);
+				inputerror ();
+			}
+		}
 	}
   
 	if (argc == 1) {  // If no commandline inputs
@@ -186,297 +466,1417 @@ int main (int argc, char *argv[])
 		get_NegBailout ();
 		get_step ();
 		get_wave_factor ();
-  }
-  
-	// Pre-lock all the data locks before spawning the threads, so the threads do not run yet.
-	lockstruct._lock1 = lockstruct._lock2 = lockstruct._lock3 = lockstruct._lock4 = false;
+	}
+
+	if (step <= 0 || (want_reduce && want_slope))
+		inputerror ();
+
+	// The binary format has one value per set and evenly spaced samples
+	if (want_binary && (want_slope || want_reduce || log_per_octave))
+		inputerror ();
+	if (out_path && (want_binary || want_reduce))
+		inputerror ();
+	if (spectrum_n && (want_binary || want_reduce || want_slope || out_path || log_per_octave))
+		inputerror ();
+
+	set_columns ();
+	twz_powers (powers, wave_factor);
+	set_samples ();
+
+	if (window > 0) {
+		if (want_slope)
+			inputerror ();
+		if (plan.samples && sample_dtz (plan.samples - 1) - window / 2 < 0) {
+			printf ("\nError: the integral windows must end before the zero point (neg <= -window/2).\n\n");
+			exit (EXIT_FAILURE);
+		}
+		plan.engine = ENGINE_INTEGRAL;
+	}
+
+	if (fold_tol > 0) {
+		if (want_slope || window > 0)
+			inputerror ();
+		plan.engine = ENGINE_FOLD;
+	}
   
-	// Declare the thread pointers & start
-	pthread_t tONE, tTWO, tTHREE, tFOUR;
-	pthread_create (&tONE, NULL, (void *) &fONE, NULL);
-	pthread_create (&tTWO, NULL, (void *) &fTWO, NULL);
-	pthread_create (&tTHREE, NULL, (void *) &fTHREE, NULL);
-	pthread_create (&tFOUR, NULL, (void *) &fFOUR, NULL);
-	  
-	set_powers ();
+	set_prefix ();
+	if (plan.engine == ENGINE_FOLD)
+		set_fold ();
+	if (spectrum_n) {
+		if (plan.samples < spectrum_n) {
+			printf ("\nError: the window holds fewer than %ld samples.\n\n", spectrum_n);
+			exit (EXIT_FAILURE);
+		}
+		set_spectrum ();
+	}
+	make_plan (&plan);
+
+	fprintf (stderr, "Plan: %ld samples, %.1Lf iterations per value, %s engine, %ld threads, chunks of %ld\n", 
+		plan.samples, plan.iterations, engine_name[plan.engine], plan.threads, plan.chunk);
+	if (num_selected < NUM_SETS)
+		fprintf (stderr, "Sets: %s\n", set_list + 2);
+	fprintf (stderr, "ETA: %.1Lf seconds", plan.seconds);
+	if (plan.seconds >= 3600)
+		fprintf (stderr, " (%.1Lf hours)", plan.seconds / 3600);
+	fprintf (stderr, "\n");
+
+	if (plan.engine == ENGINE_FOLD)
+		report_fold ();
+
+	if (plan_only)
+		exit (EXIT_SUCCESS);
+
+	if (plan.seconds > budget && !confirmed && !doublecheck (budget)) {
+		fprintf (stderr, "Not started: the estimate exceeds the budget of %.0Lf seconds (use yes or budget=)\n", budget);
+		exit (3);
+	}
+
+	num_chunks = (plan.samples + plan.chunk - 1) / plan.chunk;
+	next_chunk = printed_chunks = 0;
+
+	// No printer with file=: the workers write the rows themselves
+	if (out_path) {
+		open_fixed ();
+		start_monitor ();
+		for (i = 0; i < plan.threads; i++)
+			pthread_create (&thread[i], NULL, worker, &telemetry[i]);
+		for (i = 0; i < plan.threads; i++)
+			pthread_join (thread[i], NULL);
+		stop_monitor ();
+		if (close (out_fd)) {
+			perror ("twz-generator-threaded");
+			exit (EXIT_FAILURE);
+		}
+		return 0;
+	}
+
+	num_slots = 2 * plan.threads + 2;
+	slots = malloc (num_slots * sizeof (struct Slot));
+	for (i = 0; slots && i < num_slots; i++) {
+		slots[i].index = -1;
+		slots[i].ans = malloc ((plan.chunk + spectrum_n / 2) * sizeof (*slots[i].ans));
+		slots[i].slope = want_slope ? malloc (plan.chunk * sizeof (*slots[i].slope)) : NULL;
+		slots[i].stats = want_reduce ? malloc (sizeof (struct Stats)) : NULL;
+		slots[i].power = spectrum_n ? malloc (plan.chunk / (spectrum_n / 2) * (spectrum_n / 2 + 1) * sizeof (*slots[i].power)) : NULL;
+		if (slots[i].ans == NULL || (want_slope && slots[i].slope == NULL) || (want_reduce && slots[i].stats == NULL)
+			|| (spectrum_n && slots[i].power == NULL))
+			slots = NULL;
+	}
+	if (want_reduce && (total = malloc (sizeof (struct Stats))) != NULL)
+		stats_clear (total);
+	if (spectrum_n)
+		power = calloc (spectrum_n / 2 + 1, sizeof (*power));
+	if (slots == NULL || (want_reduce && total == NULL) || (spectrum_n && power == NULL)) {
+		printf ("\nError: Out of memory, exiting.\n\n");
+		exit (EXIT_FAILURE);
+	}
+
+	start_monitor ();
+	for (i = 0; i < plan.threads; i++)
+		pthread_create (&thread[i], NULL, worker, &telemetry[i]);
 	  
 	//printf("\n\ndtzp: %lfstep: %lfwave_factor: %d",dtzp, step, wave_factor);
-	printf ("\n%s\n", title);
+	if (want_binary) {
+		memset (&header, 0, sizeof (header));
+		strcpy (header.magic, "TWZBIN2");
+		header.rows = 1;
+		header.cols = plan.samples;
+		header.sets = num_selected;
+		header.start = dtzp;
+		header.step = step;
+		header.mask = set_mask;
+		fwrite (&header, sizeof (header), 1, stdout);
+		fwrite (&wave_factor, sizeof (int64_t), 1, stdout);
+		bytes = sizeof (header) + sizeof (int64_t);
+	} else if (want_reduce)
+		bytes += printf ("\nSummary of %ld samples from %.*Lf to %.*Lf days to zero", plan.samples, 
+			PREC, sample_dtz (0), PREC, plan.samples ? sample_dtz (plan.samples - 1) : sample_dtz (0));
+	else if (!spectrum_n)
+		bytes += printf ("\n%s", want_slope ? slope_title : title);
+	if (window > 0 && !want_binary && !spectrum_n)
+		bytes += printf (" (%s over %.*Lf days)", want_average ? "means" : "integrals", PREC, window);
+	if (!want_binary && !spectrum_n)
+		bytes += printf ("\n");
 	
-	while (dtzp >= NegativeBailout) {
-		printf ("\n%.*Lf ,", PREC, dtzp);
-		
-		// populate with the requested date
-		lockstruct.x1 = lockstruct.x2 = lockstruct.x3 = lockstruct.x4 = dtzp;
-    
-		// Set all the data locks
-		lockstruct._lock1 = lockstruct._lock2 = lockstruct._lock3 = lockstruct._lock4 = true;
-    
-		// Wait for calculated signal
-		while (true == lockstruct._lock1 || true == lockstruct._lock2 || true == lockstruct._lock3 || true == lockstruct._lock4) {
-			// Do nothing while waiting, but make progrm wait here
+	// Print (or merge) the chunks in order as the workers finish them
+	for (c = 0; c < num_chunks; c++) {
+		s = &slots[c % num_slots];
+
+		pthread_mutex_lock (&pool_lock);
+		while (s->index != c)
+			pthread_cond_wait (&chunk_done, &pool_lock);
+		pthread_mutex_unlock (&pool_lock);
+
+		first = c * plan.chunk;
+		last = first + plan.chunk < plan.samples ? first + plan.chunk : plan.samples;
+
+		if (want_reduce)
+			stats_merge (total, s->stats);
+		else if (spectrum_n) {
+			// Block by block, so the sums come out the same for any chunk size
+			for (k = 0; k < s->blocks; k++)
+				for (n = 0; n <= spectrum_n / 2; n++)
+					for (i = 0; i < NUM_SETS; i++)
+						if (set_mask & (1 << i))
+							power[n][i] += s->power[k * (spectrum_n / 2 + 1) + n][i];
+			blocks += s->blocks;
+		} else if (want_binary) {
+			for (n = first; n < last; n++) {
+				for (i = k = 0; i < NUM_SETS; i++)
+					if (set_mask & (1 << i))
+						row[k++] = s->ans[n - first][i];
+				fwrite (row, sizeof (double), num_selected, stdout);
+			}
+			bytes += (last - first) * num_selected * sizeof (double);
+		} else for (n = first; n < last; n++) {
+			bytes += printf ("\n%.*Lf ,", PREC, sample_dtz (n));
+			if (want_slope)
+				for (i = 0; i < NUM_SETS; i++) {
+					if (set_mask & (1 << i))
+						bytes += printf ("%.*Lf ,%.*Lf ,", PREC, s->ans[n - first][i], PREC, s->slope[n - first][i]);
+				}
+			else if (num_selected == NUM_SETS)
+				bytes += printf ("%.*Lf ,%.*Lf ,%.*Lf ,%.*Lf ,", PREC, s->ans[n - first][0], PREC, s->ans[n - first][1], 
+					PREC, s->ans[n - first][2], PREC, s->ans[n - first][3]);
+			else for (i = 0; i < NUM_SETS; i++)
+				if (set_mask & (1 << i))
+					bytes += printf ("%.*Lf ,", PREC, s->ans[n - first][i]);
 		}
-		
-		printf ("%.*Lf ,%.*Lf ,%.*Lf ,%.*Lf ,", PREC, lockstruct.ans1, PREC, lockstruct.ans2, PREC, lockstruct.ans3, PREC, lockstruct.ans4);
-		
-		dtzp -= step;
+		__atomic_store_n (&printed_bytes, bytes, __ATOMIC_RELAXED);
+
+		pthread_mutex_lock (&pool_lock);
+		s->index = -1;
+		printed_chunks = c + 1;
+		pthread_cond_broadcast (&slot_free);
+		pthread_mutex_unlock (&pool_lock);
 	}
+
+	for (i = 0; i < plan.threads; i++)
+		pthread_join (thread[i], NULL);
+	stop_monitor ();
+
+	if (want_reduce)
+		stats_print (total);
+	if (spectrum_n)
+		spectrum_print (power, blocks);
 }
 
 
 
-//  wave_factor is a global variable
+//  "all" or a list of set numbers "1,3"
+/*--------------*/
+int64_t parse_sets (char *s)
+{
+	int64_t sets = 0, n;
+	char *p;
+
+	if (!strcmp (s, "all"))
+		return (1 << NUM_SETS) - 1;
+
+	for (p = s; *p; ) {
+		n = strtol (p, &p, 10);
+		if (n < 1 || n > NUM_SETS)
+			return 0;
+		sets |= 1 << (n - 1);
+		if (*p == ',')
+			p++;
+		else if (*p)
+			return 0;
+	}
+
+	return sets;
+}
+
+
+
+/*  Count the sets of set_mask and build the titles of their columns  */
 /*-----------------*/ 
-void set_powers (void) 
+void set_columns (void) 
 {
-	uint64_t j;
-	
-	/*  put powers[j] = wave_factor^j  */ 
-  
-	powers[0] = (long double) 1;
-  
-	for (j = 1; j < NUM_POWERS; j++)
-		powers[j] = wave_factor * powers[j - 1];
+	int64_t set, n = 0, m = 0;
+	char slope_list[256];
+
+	num_selected = 0;
+	set_list[0] = slope_list[0] = '\0';
+	for (set = 0; set < NUM_SETS; set++)
+		if (set_mask & (1 << set)) {
+			num_selected++;
+			n += snprintf (set_list + n, sizeof (set_list) - n, ", %s", set_name[set]);
+			m += snprintf (slope_list + m, sizeof (slope_list) - m, ", %s, slope", set_name[set]);
+		}
+
+	snprintf (title, sizeof (title), "Days to Zero (DTZ)%s", set_list);
+	snprintf (slope_title, sizeof (slope_title), "Days to Zero (DTZ)%s", slope_list);
+}
+
+
+
+/*  Prefix integrals of v() over one period of each number set  */
+/*-----------------*/ 
+void set_prefix (void) 
+{
+	int64_t set, n;
+
+	for (set = 0; set < NUM_SETS; set++) {
+		w_prefix[set][0] = 0.0;
+		w_max[set] = 0.0;
+		for (n = 0; n < NUM_DATA_POINTS; n++) {
+			w_prefix[set][n + 1] = w_prefix[set][n] + (twz_w[set][n] + twz_w[set][(n + 1) % NUM_DATA_POINTS]) / 2.0L;
+			if (twz_w[set][n] > w_max[set])
+				w_max[set] = twz_w[set][n];
+		}
+	}
+}
+
+
+
+/*  Size the base-octave table for fold_tol: the interpolation error at x
+ *  is at most x * w_max / (wf^3 * wf^m * (wf-1)) for m table levels  */
+/*  (log sampling needs no table, only the first octave of samples)  */
+/*-----------------*/ 
+void set_fold (void) 
+{
+	if (log_per_octave) {
+		log_value = calloc (log_per_octave, sizeof (*log_value));
+		fold_ready = calloc (log_per_octave, 1);
+		if (log_value == NULL || fold_ready == NULL) {
+			printf ("\nError: Out of memory, exiting.\n\n");
+			exit (EXIT_FAILURE);
+		}
+		return;
+	}
+
+	for (fold_levels = 0; fold_levels < NUM_POWERS - 1; fold_levels++)
+		if (1.0L / (powers[fold_levels] * (wave_factor - 1)) <= fold_tol 
+			|| (wave_factor - 1) * powers[fold_levels + 1] + 1 > MAX_FOLD_NODES)
+			break;
+
+	fold_h = 1.0L / powers[fold_levels];
+	fold_nodes = (int64_t) ((wave_factor - 1) * powers[fold_levels]) + 1;
+	fold_bound = 1.0L / (powers[fold_levels] * (wave_factor - 1));
+
+	// calloc leaves the pages untouched until a node is filled in
+	fold_value = calloc (fold_nodes, sizeof (*fold_value));
+	fold_ready = calloc (fold_nodes, 1);
+	if (fold_value == NULL || fold_ready == NULL) {
+		printf ("\nError: Out of memory, exiting.\n\n");
+		exit (EXIT_FAILURE);
+	}
+}
+
+
+
+/*  Print the error bound of the folding and the largest errors seen on a
+ *  few folded samples of the window, against the full series (which the bound
+ *  covers) and against f() (which also differs from the series where its
+ *  fine loop stops at a zero term), all relative to the scale x*max(w)/wf^3
+ *  of the wave at each sample  */
+/*-----------------*/ 
+void report_fold (void) 
+{
+	int64_t n, set, stride;
+	long double x, ans[NUM_SETS], scale, err = 0.0, err_f = 0.0, max_w = 0.0;
+
+	for (set = 0; set < NUM_SETS; set++)
+		if (w_max[set] > max_w)
+			max_w = w_max[set];
+
+	stride = plan.samples / PROBE_POINTS + 1;
+	for (n = 0; n < plan.samples; n += stride) {
+		x = sample_dtz (n);
+		if (!f_fold (n, ans))
+			continue;
+		scale = div_power (x * max_w, 3);
+		for (set = 0; set < NUM_SETS; set++) {
+			if (!(set_mask & (1 << set)))
+				continue;
+			err = fmaxl (err, fabsl (ans[set] - fold_series (x, set)) / scale);
+			err_f = fmaxl (err_f, fabsl (ans[set] - twz_f (x, twz_w[set], powers)) / scale);
+		}
+	}
+
+	if (log_per_octave)
+		fprintf (stderr, "Fold: %ld samples of the first octave serve the %ld before zero, exact up to rounding\n", 
+			log_before < log_per_octave ? log_before : log_per_octave, log_before);
+	else
+		fprintf (stderr, "Fold: %ld nodes at spacing 1/%.0Lf, error bound %.2Le of x*max(w)/wf^3\n", 
+			fold_nodes, powers[fold_levels], fold_bound);
+	fprintf (stderr, "Fold: largest error seen %.2Le against the full series, %.2Le against f()\n", err, err_f);
+	if (fold_bound > fold_tol)
+		fprintf (stderr, "Fold: the table is capped at %d nodes, so tol=%.2Le is not reached\n", MAX_FOLD_NODES, fold_tol);
+}
+
+
+
+/*  Octave of x > 0: returns k and sets *u so that x = wf^k * u, 1 <= u < wf  */
+/*-----------------*/ 
+int64_t fold_octave (long double x, long double *u) 
+{
+	int64_t k = 0;
+
+	for (k = 0; k + 1 < NUM_POWERS && x >= powers[k + 1]; k++)
+		;
+	while (k > 1 - NUM_POWERS && x < (k >= 0 ? powers[k] : 1.0L / powers[-k]))
+		k--;
+
+	*u = k >= 0 ? div_power (x, k) : mult_power (x, -k);
+	return k;
 }
 
 
 
-/*  x is number of days to zero date  */ 
+/*  The wave at x > 0 with the fine levels summed until the rest cannot
+ *  change the sum.  f() stops at the first fine term that is exactly zero;
+ *  in the base octave that can drop whole levels which the coarse loop of
+ *  f(wf^k * u) keeps, so the nodes use the full series.
+ */
 /*--------------*/ 
-long double f (long double x, int64_t number_set) 
+long double fold_series (long double x, int64_t number_set) 
 {
-	uint64_t i;
+	int64_t i;
+	long double sum = 0.0;
 
-	long double sum = 0.0, last_sum = 0.0;
-	
-	if (x) {
-		for (i = 0; x >= powers[i]; i++)
-			sum += mult_power (v (div_power (x, i), number_set), i);
-    
-		i = 0;
-		do {
-			if (++i > CALC_PREC + 2)
-				break;
-			
-			last_sum = sum;
-			sum += div_power (v (mult_power (x, i), number_set), i);
-		
-		} while ((sum == 0.0) || (sum > last_sum));
+	for (i = 0; i < NUM_POWERS && x >= powers[i]; i++)
+		sum += mult_power (twz_v (div_power (x, i), twz_w[number_set], NULL), i);
+
+	for (i = 1; i < NUM_POWERS; i++) {
+		sum += div_power (twz_v (mult_power (x, i), twz_w[number_set], NULL), i);
+		if (div_power (w_max[number_set], i) <= sum * (wave_factor - 1) * LDBL_EPSILON)
+			break;
 	}
-  
-  
-	/*  dividing by 64^3 gives values consistent with the Apple // version
-	*  and provides more convenient y-axis labels
-	*/ 
-	sum = div_power (sum, 3);
-	
-	return (sum);
+
+	return div_power (sum, 3);
 }
 
 
 
-/*  x is number of days to zero date  */ 
+/*  f() for the selected number sets at sample n through the base-octave table.
+ *  Samples further apart than the table spacing (scaled to their octave)
+ *  gain nothing from it and are evaluated directly.  Log samples before
+ *  zero are wf^-q times the series at their sample of the first octave.
+ *  Returns TRUE when the sample was folded.
+ */
 /*--------------*/ 
-void * fONE (void) 
-{
-	onestart:
-	;			// This semicolon is required on GCC and ignored elsewhere
-	// Wait until the lock is un-set, then run
-	do {
-		// Do Nothing
-    } while (false == lockstruct._lock1);
-  
-  
-	int64_t number_set = 0;
-	uint64_t i;
-	long double sum = 0.0, last_sum = 0.0;
-	long double x = lockstruct.x1;
-  
-	if (x) {
-		for (i = 0; x >= powers[i]; i++)
-			sum += mult_power (v (div_power (x, i), number_set), i);
-	    
-		i = 0;
-		do {
-			if (++i > CALC_PREC + 2)
-				break;
-			
-		last_sum = sum;
-		sum += div_power (v (mult_power (x, i), number_set), i);
-		
-		} while ((sum == 0.0) || (sum > last_sum));
+int64_t f_fold (int64_t n, long double *ans) 
+{
+	int64_t k, j, node, set;
+	long double x = sample_dtz (n), u = 0.0, t, scale;
+
+	if (log_per_octave && n < log_before) {
+		j = n % log_per_octave;
+		if (!__atomic_load_n (&fold_ready[j], __ATOMIC_ACQUIRE)) {
+			for (set = 0; set < NUM_SETS; set++)
+				if (set_mask & (1 << set))
+					log_value[j][set] = fold_series (log_base[0][j], set);
+			__atomic_store_n (&fold_ready[j], 1, __ATOMIC_RELEASE);
+		}
+		for (set = 0; set < NUM_SETS; set++)
+			if (set_mask & (1 << set))
+				ans[set] = div_power (log_value[j][set], n / log_per_octave);
+		return TRUE;
 	}
-  
-	/*  dividing by 64^3 gives values consistent with the Apple // version
-	*  and provides more convenient y-axis labels
-	*/ 
-	sum = div_power (sum, 3);
-	
-	// Done : Reset everything for next run
-	lockstruct.ans1 = sum;
-	lockstruct._lock1 = false;
-	goto onestart;
-  
-	return 0;
+
+	k = x > 0 ? fold_octave (x, &u) : 0;
+	scale = k >= 0 ? powers[k] : 1.0L / powers[-k];
+
+	if (x <= 0 || log_per_octave || step >= fold_h * scale) {
+		for (set = 0; set < NUM_SETS; set++)
+			if (set_mask & (1 << set))
+				ans[set] = twz_f (x, twz_w[set], powers);
+		return FALSE;
+	}
+
+	t = (u - 1) / fold_h;
+	j = (int64_t) t;
+	if (j > fold_nodes - 2)
+		j = fold_nodes - 2;
+	t -= j;
+
+	for (node = j; node <= j + 1; node++)
+		if (!__atomic_load_n (&fold_ready[node], __ATOMIC_ACQUIRE)) {
+			for (set = 0; set < NUM_SETS; set++)
+				if (set_mask & (1 << set))
+					fold_value[node][set] = fold_series (1 + node * fold_h, set);
+			__atomic_store_n (&fold_ready[node], 1, __ATOMIC_RELEASE);
+		}
+
+	for (set = 0; set < NUM_SETS; set++)
+		if (set_mask & (1 << set))
+			ans[set] = scale * (fold_value[j][set] * (1 - t) + fold_value[j + 1][set] * t);
+
+	return TRUE;
 }
 
 
-/*  x is number of days to zero date  */ 
+
 /*--------------*/ 
-void * fTWO (void) 
+void stats_clear (struct Stats *s) 
 {
-	twostart:
-	;			// This semicolon is required on GCC and ignored elsewhere
-	
-	// Wait until the lock is un-set, then run 
-	do {
-		// Do Nothing
-	} while (false == lockstruct._lock2);
-  
-	int64_t number_set = 1;
-	uint64_t i;
-	long double sum = 0.0, last_sum = 0.0;
-	long double x = lockstruct.x2;
-  
-	if (x) {
-		for (i = 0; x >= powers[i]; i++)
-			sum += mult_power (v (div_power (x, i), number_set), i);
-    
-		i = 0;
-		do {
-			if (++i > CALC_PREC + 2)
-				break;
+	memset (s, 0, sizeof (struct Stats));
+}
 
-			last_sum = sum;
-			sum += div_power (v (mult_power (x, i), number_set), i);
-      
-	    } while ((sum == 0.0) || (sum > last_sum));
-  }
-  
-  
-	/*  dividing by 64^3 gives values consistent with the Apple // version
-	*  and provides more convenient y-axis labels
-	*/ 
-	sum = div_power (sum, 3);
-  
-	// Done : Reset everything for next run
-	lockstruct.ans2 = sum;
-	lockstruct._lock2 = false;
-	goto twostart;
-  
-	return 0;
+
+
+/*  Add the values ans of the selected sets at dtz x  */
+/*--------------*/ 
+void stats_add (struct Stats *s, long double x, long double *ans) 
+{
+	int64_t a, b, bin;
+	long double delta[NUM_SETS];
+
+	s->n++;
+	for (a = 0; a < NUM_SETS; a++) {
+		if (!(set_mask & (1 << a)))
+			continue;
+		if (s->n == 1 || ans[a] < s->min[a]) {
+			s->min[a] = ans[a];
+			s->min_at[a] = x;
+		}
+		if (s->n == 1 || ans[a] > s->max[a]) {
+			s->max[a] = ans[a];
+			s->max_at[a] = x;
+		}
+		delta[a] = ans[a] - s->mean[a];
+		s->mean[a] += delta[a] / s->n;
+	}
+
+	for (a = 0; a < NUM_SETS; a++)
+		for (b = 0; b < NUM_SETS; b++)
+			if (set_mask & (1 << a) && set_mask & (1 << b))
+				s->c[a][b] += delta[a] * (ans[b] - s->mean[b]);
+
+	if (hist_bins)
+		for (a = 0; a < NUM_SETS; a++) {
+			if (!(set_mask & (1 << a)))
+				continue;
+			if (ans[a] < hist_lo)
+				bin = 0;
+			else if (ans[a] >= hist_hi)
+				bin = hist_bins + 1;
+			else
+				bin = 1 + (int64_t) ((ans[a] - hist_lo) / (hist_hi - hist_lo) * hist_bins);
+			if (bin > hist_bins)		//  rounding just below hist_hi
+				bin = hist_bins;
+			s->hist[a][bin]++;
+		}
 }
 
 
-/*  x is number of days to zero date  */ 
+
+/*  Add the stretch t, which follows the one in s  */
 /*--------------*/ 
-void * fTHREE (void) 
+void stats_merge (struct Stats *s, struct Stats *t) 
 {
-	threestart:
-	;			// This semicolon is required on GCC and ignored elsewhere
-	
-	// Wait until the lock is un-set, then run
-  	do {
-	    // Do Nothing
-	} while (false == lockstruct._lock3);
-  
-  
-	int64_t number_set = 2;
-	uint64_t i;
-	long double sum = 0.0, last_sum = 0.0;
-	long double x = lockstruct.x3;
-  
-	if (x) {
-		for (i = 0; x >= powers[i]; i++)
-			sum += mult_power (v (div_power (x, i), number_set), i);
-    
-		i = 0;
-		do {
-			if (++i > CALC_PREC + 2)
+	int64_t a, b, bin, n = s->n + t->n;
+	long double delta[NUM_SETS];
+
+	if (t->n == 0)
+		return;
+
+	for (a = 0; a < NUM_SETS; a++) {
+		if (s->n == 0 || t->min[a] < s->min[a]) {
+			s->min[a] = t->min[a];
+			s->min_at[a] = t->min_at[a];
+		}
+		if (s->n == 0 || t->max[a] > s->max[a]) {
+			s->max[a] = t->max[a];
+			s->max_at[a] = t->max_at[a];
+		}
+		delta[a] = t->mean[a] - s->mean[a];
+	}
+
+	for (a = 0; a < NUM_SETS; a++)
+		for (b = 0; b < NUM_SETS; b++)
+			s->c[a][b] += t->c[a][b] + delta[a] * delta[b] * s->n * t->n / n;
+
+	for (a = 0; a < NUM_SETS; a++) {
+		s->mean[a] += delta[a] * t->n / n;
+		for (bin = 0; bin < hist_bins + 2; bin++)
+			s->hist[a][bin] += t->hist[a][bin];
+	}
+
+	s->n = n;
+}
+
+
+
+/*  The summary: one row per set, the correlation matrix and the histogram.
+ *  The variance is that of the samples of the window (divided by n).  */
+/*--------------*/ 
+void stats_print (struct Stats *s) 
+{
+	int64_t a, b, bin;
+
+	printf ("\nSet, Minimum, at DTZ, Maximum, at DTZ, Mean, Variance, Standard deviation");
+	for (a = 0; a < NUM_SETS; a++) {
+		if (!(set_mask & (1 << a)))
+			continue;
+		printf ("\n%s ,", set_name[a]);
+		if (s->n == 0)
+			continue;
+		printf ("%.*Lf ,%.*Lf ,%.*Lf ,%.*Lf ,%.*Lf ,%.*Le ,%.*Le ,", PREC, s->min[a], PREC, s->min_at[a], 
+			PREC, s->max[a], PREC, s->max_at[a], PREC, s->mean[a], PREC, s->c[a][a] / s->n, 
+			PREC, sqrtl (s->c[a][a] / s->n));
+	}
+
+	printf ("\n\nCorrelation%s", set_list);
+	for (a = 0; a < NUM_SETS; a++) {
+		if (!(set_mask & (1 << a)))
+			continue;
+		printf ("\n%s ,", set_name[a]);
+		for (b = 0; b < NUM_SETS; b++)
+			if (set_mask & (1 << b))
+				printf ("%.*Lf ,", PREC, s->c[a][b] / sqrtl (s->c[a][a] * s->c[b][b]));
+	}
+
+	if (hist_bins) {
+		printf ("\n\nFrom, To%s", set_list);
+		for (bin = 0; bin < hist_bins + 2; bin++) {
+			if (bin == 0)
+				printf ("\n-inf ,%.*Lf ,", PREC, hist_lo);
+			else if (bin > hist_bins)
+				printf ("\n%.*Lf ,inf ,", PREC, hist_hi);
+			else
+				printf ("\n%.*Lf ,%.*Lf ,", PREC, hist_lo + (hist_hi - hist_lo) * (bin - 1) / hist_bins, 
+					PREC, hist_lo + (hist_hi - hist_lo) * bin / hist_bins);
+			for (a = 0; a < NUM_SETS; a++)
+				if (set_mask & (1 << a))
+					printf ("%ld ,", s->hist[a][bin]);
+		}
+	}
+	printf ("\n");
+}
+
+
+
+/*  Count the samples of the window into plan.samples, and for log
+ *  sampling lay out the first octave on each side of zero  */
+/*--------------*/ 
+void set_samples (void) 
+{
+	int64_t r, side;
+	long double lo, hi;
+
+	if (!log_per_octave) {
+		plan.samples = dtzp < NegativeBailout ? 0 : (int64_t) floorl ((dtzp - NegativeBailout) / step + 1e-9L) + 1;
+		return;
+	}
+
+	// Before zero from dtz down to step (or to where the window ends)
+	lo = NegativeBailout > step ? NegativeBailout : step;
+	log_before = dtzp < lo ? 0 : (int64_t) floorl (log_per_octave * logl (dtzp / lo) / logl (wave_factor) + 1e-9L) + 1;
+
+	log_zero = dtzp >= 0 && NegativeBailout <= 0;
+
+	// After zero from step (or from where the window starts) up to neg
+	lo = -dtzp > step ? -dtzp : step;
+	hi = -NegativeBailout;
+	log_after = hi < lo ? 0 : (int64_t) floorl (log_per_octave * logl (hi / lo) / logl (wave_factor) + 1e-9L) + 1;
+
+	if (log_before > (NUM_POWERS - 1) * log_per_octave || log_after > (NUM_POWERS - 1) * log_per_octave) {
+		printf ("\nError: the window spans more than %d octaves of the wave factor.\n\n", NUM_POWERS - 1);
+		exit (EXIT_FAILURE);
+	}
+
+	for (side = 0; side < 2; side++) {
+		log_base[side] = malloc (log_per_octave * sizeof (long double));
+		if (log_base[side] == NULL) {
+			printf ("\nError: Out of memory, exiting.\n\n");
+			exit (EXIT_FAILURE);
+		}
+	}
+	for (r = 0; r < log_per_octave; r++) {
+		log_base[0][r] = dtzp * powl (wave_factor, -(long double) r / log_per_octave);
+		log_base[1][r] = -lo * powl (wave_factor, (long double) r / log_per_octave);
+	}
+
+	plan.samples = log_before + log_zero + log_after;
+}
+
+
+
+/*  Sample n of the window  */
+/*--------------*/ 
+long double sample_dtz (int64_t n) 
+{
+	if (!log_per_octave)
+		return dtzp - n * step;
+
+	if (n < log_before)
+		return div_power (log_base[0][n % log_per_octave], n / log_per_octave);
+	n -= log_before;
+	if (n < log_zero)
+		return 0.0;
+	n -= log_zero;
+
+	return mult_power (log_base[1][n % log_per_octave], n / log_per_octave);
+}
+
+
+
+/*  Seconds on a monotonic clock  */
+/*--------------*/ 
+long double now (void) 
+{
+	struct timespec t;
+
+	clock_gettime (CLOCK_MONOTONIC, &t);
+	return t.tv_sec + t.tv_nsec * 1e-9L;
+}
+
+
+
+/*  Cost model: the expected loop iterations of f() at x for one number set.
+ *  The coarse loop runs once per power of the wave factor up to x.  The sum
+ *  is about w*x, and the fine terms about w/wf^i, so the fine loop runs
+ *  until wf^i passes 2^64/x, where the terms drop below the last bit of
+ *  the sum.  *shared gets the iterations with the incremental engine, which
+ *  only redoes the coarse levels whose segment changed since the previous
+ *  sample, one step earlier.
+ */
+/*--------------*/ 
+long double iterations (long double x, long double *shared) 
+{
+	int64_t i;
+	long double coarse = 0.0, redone = 1.0, fine;
+
+	x = fabsl (x);
+	if (x == 0.0) {
+		*shared = 0.0;
+		return 0.0;
+	}
+
+	for (i = 0; i < NUM_POWERS && x >= powers[i]; i++) {
+		coarse++;
+		redone += step < powers[i] ? step / powers[i] : 1.0;
+	}
+
+	fine = ceill ((64 * M_LN2 - logl (x)) / logl (wave_factor));
+	if (fine < 1)
+		fine = 1;
+	if (fine > NUM_POWERS - 1)
+		fine = NUM_POWERS - 1;
+
+	*shared = fine + (coarse ? redone : coarse);
+	return coarse + fine;
+}
+
+
+
+/*  Fill in the plan: the engine with the fewer expected iterations, and the time per sample from timing f() on a few samples of
+ *  the window.  Printing is done by one thread, so the run takes at least
+ *  the printing time whatever the thread count; threads beyond the ones
+ *  that keep the printer busy are not started.  The workers and the printer
+ *  also share the processors, so the run takes at least their total work
+ *  spread over all of them.
+ */
+/*--------------*/ 
+void make_plan (struct Plan *p) 
+{
+	int64_t n, set, cpus, stride, pass, length, probes = 0;
+	long double exact = 0.0, shared = 0.0, shared_n, probe_iterations = 0.0, u, fill;
+	int64_t folded = 0;
+	struct Stats *probe_stats;
+	long double start, per_iteration, per_sample, print_per_sample, calc;
+	volatile long double sink = 0.0;
+	long double ans_probe[NUM_SETS];
+	char row[256];
+	double *probe_re;
+
+	stride = p->samples / MODEL_POINTS + 1;
+	for (n = 0; n < p->samples; n += stride) {
+		exact += iterations (sample_dtz (n), &shared_n);
+		shared += shared_n;
+		if (p->engine == ENGINE_FOLD && (log_per_octave ? n < log_before : 
+			sample_dtz (n) > 0 && step < mult_power (fold_h, fold_octave (sample_dtz (n), &u))))
+			folded++;
+		probes++;
+	}
+	if (probes) {
+		exact /= probes;
+		shared /= probes;
+	}
+
+	// Log samples are too far apart to share coarse levels
+	if (log_per_octave)
+		shared = exact;
+
+	// Folded samples cost an interpolation, and at most every node of the
+	// table (or sample of the first octave) one evaluation
+	if (p->engine == ENGINE_FOLD && probes) {
+		fill = (log_per_octave ? log_per_octave : fold_nodes) * iterations (wave_factor / 2.0L, &shared_n);
+		exact = exact * (1 - (long double) folded / probes) + (long double) folded / probes 
+			+ (p->samples ? fminl (fill, exact * p->samples * folded / probes) / p->samples : 0.0);
+	}
+
+	if (p->engine < 0)
+		p->engine = shared < 0.8 * exact ? ENGINE_INCREMENTAL : ENGINE_EXACT;
+
+	// An integral level costs about two f() iterations
+	if (p->engine == ENGINE_INTEGRAL)
+		exact *= 2;
+	p->iterations = p->engine == ENGINE_INCREMENTAL ? shared : exact;
+
+	// Calibrate: time f() and the printing of a row on samples spread over
+	// the window, the second time round so the caches are warm
+	stride = p->samples / PROBE_POINTS + 1;
+	for (pass = 0; pass < 2; pass++) {
+		probe_iterations = 0.0;
+		start = now ();
+		for (n = 0, probes = 0; n < p->samples; n += stride, probes++) {
+			probe_iterations += iterations (sample_dtz (n), &shared_n);
+			for (set = 0; set < NUM_SETS; set++)
+				if (set_mask & (1 << set))
+					sink += twz_f (sample_dtz (n), twz_w[set], powers);
+		}
+	}
+	per_iteration = probe_iterations ? (now () - start) / (probe_iterations * num_selected) : 0.0;
+
+	// Only the selected sets are calculated and printed, so what the others
+	// would cost goes to more samples per second from the same threads
+	start = now ();
+	for (n = 0; n < probes; n++) {
+		length = snprintf (row, sizeof (row), "\n%.*Lf ,", PREC, sample_dtz (n));
+		for (set = 0; set < num_selected; set++)
+			length += snprintf (row + length, sizeof (row) - length, "%.*Lf ,", PREC, sink);
+	}
+	print_per_sample = probes ? (now () - start) / probes : 0.0;
+	if (want_slope)
+		print_per_sample *= 2;
+
+	per_sample = per_iteration * p->iterations * num_selected;
+
+	// Reducing moves the output work from the printer to the workers
+	if (want_reduce && (probe_stats = malloc (sizeof (struct Stats))) != NULL) {
+		ans_probe[0] = ans_probe[1] = ans_probe[2] = ans_probe[3] = sink;
+		stats_clear (probe_stats);
+		start = now ();
+		for (n = 0; n < probes; n++)
+			stats_add (probe_stats, sample_dtz (n), ans_probe);
+		per_sample += probes ? (now () - start) / probes : 0.0;
+		print_per_sample = 0.0;
+		free (probe_stats);
+	}
+
+	// and so do the transforms of the spectrum, two sets at a time in
+	// one complex transform, for each block of spectrum_n / 2 new samples
+	if (spectrum_n && (probe_re = calloc (2 * spectrum_n, sizeof (double))) != NULL) {
+		fft (probe_re, probe_re + spectrum_n);
+		start = now ();
+		fft (probe_re, probe_re + spectrum_n);
+		per_sample += (now () - start) * ((num_selected + 1) / 2) / (spectrum_n / 2);
+		print_per_sample = 0.0;
+		free (probe_re);
+	}
+
+	// and so does writing the rows in place
+	if (out_path) {
+		per_sample += print_per_sample;
+		print_per_sample = 0.0;
+	}
+	calc = per_sample * p->samples;
+
+	cpus = sysconf (_SC_NPROCESSORS_ONLN);
+	if (cpus < 1)
+		cpus = 1;
+
+	if (p->threads == 0) {
+		p->threads = 1;
+		if (calc > 0.02)
+			p->threads = print_per_sample > 0.0 ? (int64_t) ceill (per_sample / print_per_sample) : cpus;
+		if (p->threads > cpus)
+			p->threads = cpus;
+		if (p->threads > MAX_THREADS)
+			p->threads = MAX_THREADS;
+		if (p->threads < 1)
+			p->threads = 1;
+	}
+
+	// Enough chunks for the threads to even out, but not so small that
+	// handing them out costs more than computing them
+	if (p->chunk == 0) {
+		p->chunk = p->samples / (8 * p->threads);
+		if (p->chunk < MIN_CHUNK)
+			p->chunk = MIN_CHUNK;
+		if (p->chunk > MAX_CHUNK)
+			p->chunk = MAX_CHUNK;
+	}
+
+	// Spectrum blocks start every spectrum_n / 2 samples, at the start of a chunk
+	if (spectrum_n)
+		p->chunk = (p->chunk + spectrum_n / 2 - 1) / (spectrum_n / 2) * (spectrum_n / 2);
+
+	p->seconds = p->samples * fmaxl (fmaxl (per_sample / p->threads, print_per_sample), 
+		(per_sample + print_per_sample) / cpus);
+}
+
+
+
+/*  Take the next chunk, compute it into its slot, repeat.  With file= the
+ *  chunk goes to the worker's own buffers and straight into the file, so
+ *  there is no slot to wait for.
+ */
+/*--------------*/ 
+void *worker (void *arg) 
+{
+	int64_t c, n, first, last;
+	long double started;
+	struct Telemetry *t = arg;
+	struct Slot *s;
+	struct twz_levels *cache = NULL;
+	long double (*ans)[NUM_SETS] = NULL, (*slope)[NUM_SETS] = NULL;
+	char *text = NULL;
+	double *re = NULL;
+
+	// The incremental engine shares the coarse levels of twz-levels.h
+	if (plan.engine == ENGINE_INCREMENTAL && (cache = malloc (sizeof (struct twz_levels)))) {
+		twz_levels_start (cache, wave_factor);
+		cache->sets = set_mask;
+	}
+
+	if (spectrum_n && (re = malloc (2 * spectrum_n * sizeof (double))) == NULL) {
+		printf ("\nError: Out of memory, exiting.\n\n");
+		exit (EXIT_FAILURE);
+	}
+
+	if (out_path) {
+		ans = malloc (plan.chunk * sizeof (*ans));
+		slope = want_slope ? malloc (plan.chunk * sizeof (*slope)) : NULL;
+		text = malloc (plan.chunk * row_bytes + 1);
+		if (ans == NULL || (want_slope && slope == NULL) || text == NULL) {
+			printf ("\nError: Out of memory, exiting.\n\n");
+			exit (EXIT_FAILURE);
+		}
+	}
+
+	for (;;) {
+		pthread_mutex_lock (&pool_lock);
+		c = next_chunk++;
+		while (!out_path && c < num_chunks && c >= printed_chunks + num_slots)
+			pthread_cond_wait (&slot_free, &pool_lock);
+		pthread_mutex_unlock (&pool_lock);
+
+		if (c >= num_chunks)
+			break;
+
+		first = c * plan.chunk;
+		last = first + plan.chunk < plan.samples ? first + plan.chunk : plan.samples;
+		started = now ();
+		__atomic_store_n (&t->current, first, __ATOMIC_RELAXED);
+
+		// With file= there is no slot
+		s = out_path ? NULL : &slots[c % num_slots];
+		if (out_path) {
+			compute_chunk (first, last, ans, slope, cache);
+			write_chunk (first, last, ans, slope, text);
+			__atomic_store_n (&t->bytes, t->bytes + (last - first) * row_bytes, __ATOMIC_RELAXED);
+		} else {
+			// A spectrum block reaches up to spectrum_n / 2 samples into the next chunk
+			if (spectrum_n) {
+				compute_chunk (first, last + spectrum_n / 2 < plan.samples ? last + spectrum_n / 2 : plan.samples, 
+					s->ans, s->slope, cache);
+				spectrum_chunk (first, last, s, re, re + spectrum_n);
+			} else
+				compute_chunk (first, last, s->ans, s->slope, cache);
+
+			if (want_reduce) {
+				stats_clear (s->stats);
+				for (n = first; n < last; n++)
+					stats_add (s->stats, sample_dtz (n), s->ans[n - first]);
+			}
+		}
+
+		// Only this worker writes its counters
+		__atomic_store_n (&t->busy_ns, t->busy_ns + (int64_t) ((now () - started) * 1e9L), __ATOMIC_RELAXED);
+		__atomic_store_n (&t->samples, t->samples + last - first, __ATOMIC_RELAXED);
+		__atomic_store_n (&t->current, -1, __ATOMIC_RELAXED);
+
+		if (out_path)
+			continue;
+
+		pthread_mutex_lock (&pool_lock);
+		s->index = c;
+		pthread_cond_broadcast (&chunk_done);
+		pthread_mutex_unlock (&pool_lock);
+	}
+
+	free (cache);
+	free (ans);
+	free (slope);
+	free (text);
+	free (re);
+	return NULL;
+}
+
+
+
+/*  Samples first to last - 1 of the window with the planned engine, for
+ *  the selected sets only  */
+/*--------------*/ 
+void compute_chunk (int64_t first, int64_t last, long double (*ans)[NUM_SETS], long double (*slope)[NUM_SETS], 
+	struct twz_levels *cache) 
+{
+	int64_t n, set;
+
+	if (plan.engine == ENGINE_INTEGRAL) {
+		for (n = first; n < last; n++)
+			for (set = 0; set < NUM_SETS; set++) {
+				if (!(set_mask & (1 << set)))
+					continue;
+				ans[n - first][set] = f_integral (sample_dtz (n) - window / 2, sample_dtz (n) + window / 2, set);
+				if (want_average)
+					ans[n - first][set] /= window;
+			}
+	} else if (plan.engine == ENGINE_FOLD) {
+		for (n = first; n < last; n++)
+			f_fold (n, ans[n - first]);
+	} else if (cache) {
+		cache->top = -1;
+		for (n = first; n < last; n++)
+			twz_levels_eval (cache, sample_dtz (n), ans[n - first], want_slope ? slope[n - first] : NULL);
+	} else if (want_slope) {
+		for (n = first; n < last; n++)
+			for (set = 0; set < NUM_SETS; set++)
+				if (set_mask & (1 << set))
+					ans[n - first][set] = twz_f_slope (sample_dtz (n), twz_w[set], powers, &slope[n - first][set]);
+	} else {
+		for (n = first; n < last; n++)
+			for (set = 0; set < NUM_SETS; set++)
+				if (set_mask & (1 << set))
+					ans[n - first][set] = twz_f (sample_dtz (n), twz_w[set], powers);
+	}
+}
+
+
+
+/*  Create the file= output with its title and preallocate it to its final
+ *  size, so the workers only fill it in  */
+/*--------------*/ 
+void open_fixed (void) 
+{
+	char header[512];
+	int err;
+
+	header_bytes = snprintf (header, sizeof (header), "\n%s", want_slope ? slope_title : title);
+	if (window > 0)
+		header_bytes += snprintf (header + header_bytes, sizeof (header) - header_bytes, " (%s over %.*Lf days)", 
+			want_average ? "means" : "integrals", PREC, window);
+	header_bytes += snprintf (header + header_bytes, sizeof (header) - header_bytes, "\n\n");
+
+	row_bytes = (1 + num_selected * (want_slope ? 2 : 1)) * (FIELD_WIDTH + 2) + 1;
+
+	out_fd = open (out_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (out_fd < 0 || pwrite (out_fd, header, header_bytes, 0) != header_bytes) {
+		perror (out_path);
+		exit (EXIT_FAILURE);
+	}
+
+	// Not every file system can preallocate; the size is what matters
+	err = posix_fallocate (out_fd, 0, header_bytes + plan.samples * row_bytes);
+	if (err && ftruncate (out_fd, header_bytes + plan.samples * row_bytes)) {
+		perror (out_path);
+		exit (EXIT_FAILURE);
+	}
+}
+
+
+
+/*  Format samples first to last - 1 and write them at their offset  */
+/*--------------*/ 
+void write_chunk (int64_t first, int64_t last, long double (*ans)[NUM_SETS], long double (*slope)[NUM_SETS], char *text) 
+{
+	int64_t n, set, ok = TRUE;
+	char *p = text;
+	off_t offset = header_bytes + first * row_bytes;
+	ssize_t done;
+
+	for (n = first; n < last; n++) {
+		ok &= format_field (p, sample_dtz (n));
+		p += FIELD_WIDTH + 2;
+		for (set = 0; set < NUM_SETS; set++) {
+			if (!(set_mask & (1 << set)))
+				continue;
+			ok &= format_field (p, ans[n - first][set]);
+			p += FIELD_WIDTH + 2;
+			if (slope) {
+				ok &= format_field (p, slope[n - first][set]);
+				p += FIELD_WIDTH + 2;
+			}
+		}
+		*p++ = '\n';
+	}
+
+	if (!ok) {
+		printf ("\nError: a value does not fit in %d characters, exiting.\n\n", FIELD_WIDTH);
+		exit (EXIT_FAILURE);
+	}
+
+	for (p = text; p < text + (last - first) * row_bytes; p += done, offset += done) {
+		done = pwrite (out_fd, p, text + (last - first) * row_bytes - p, offset);
+		if (done <= 0) {
+			perror (out_path);
+			exit (EXIT_FAILURE);
+		}
+	}
+}
+
+
+
+/*  One value and its separator, FIELD_WIDTH + 2 characters; returns FALSE
+ *  if it came out wider  */
+/*--------------*/ 
+int64_t format_field (char *p, long double value) 
+{
+	return snprintf (p, FIELD_WIDTH + 3, "%*.*Le ,", FIELD_WIDTH, PREC, value) == FIELD_WIDTH + 2;
+}
+
+
+
+/*  The Hann window and the twiddle factors of the spectrum_n point transform  */
+/*--------------*/ 
+void set_spectrum (void) 
+{
+	int64_t j;
+
+	hann = malloc (spectrum_n * sizeof (double));
+	twiddle_re = malloc (spectrum_n / 2 * sizeof (double));
+	twiddle_im = malloc (spectrum_n / 2 * sizeof (double));
+	if (hann == NULL || twiddle_re == NULL || twiddle_im == NULL) {
+		printf ("\nError: Out of memory, exiting.\n\n");
+		exit (EXIT_FAILURE);
+	}
+
+	hann_power = 0.0;
+	for (j = 0; j < spectrum_n; j++) {
+		hann[j] = 0.5 - 0.5 * cos (2 * M_PI * j / spectrum_n);
+		hann_power += hann[j] * hann[j];
+	}
+	for (j = 0; j < spectrum_n / 2; j++) {
+		twiddle_re[j] = cos (2 * M_PI * j / spectrum_n);
+		twiddle_im[j] = -sin (2 * M_PI * j / spectrum_n);
+	}
+}
+
+
+
+/*  In-place radix-2 transform of spectrum_n complex values  */
+/*--------------*/ 
+void fft (double *re, double *im) 
+{
+	int64_t i, j, k, len, half, stride;
+	double t, wr, wi, xr, xi;
+
+	for (i = 1, j = 0; i < spectrum_n; i++) {
+		for (k = spectrum_n >> 1; j & k; k >>= 1)
+			j ^= k;
+		j |= k;
+		if (i < j) {
+			t = re[i]; re[i] = re[j]; re[j] = t;
+			t = im[i]; im[i] = im[j]; im[j] = t;
+		}
+	}
+
+	for (len = 2; len <= spectrum_n; len <<= 1) {
+		half = len >> 1;
+		stride = spectrum_n / len;
+		for (i = 0; i < spectrum_n; i += len)
+			for (k = 0; k < half; k++) {
+				wr = twiddle_re[k * stride];
+				wi = twiddle_im[k * stride];
+				xr = re[i + k + half] * wr - im[i + k + half] * wi;
+				xi = re[i + k + half] * wi + im[i + k + half] * wr;
+				re[i + k + half] = re[i + k] - xr;
+				im[i + k + half] = im[i + k] - xi;
+				re[i + k] += xr;
+				im[i + k] += xi;
+			}
+	}
+}
+
+
+
+/*  |X(k)|^2 of each block that starts in the chunk [first, last); the
+ *  slot also holds the spectrum_n / 2 samples after it.  Two sets go
+ *  through one transform, one as the real and one as the imaginary part,
+ *  and are separated again by the symmetry of real transforms:
+ *  X(k) = (Z(k) + conj Z(n-k)) / 2 and Y(k) = (Z(k) - conj Z(n-k)) / 2i.
+ *  An odd set out of the selection goes through with a zero imaginary part.
+ */
+/*--------------*/ 
+void spectrum_chunk (int64_t first, int64_t last, struct Slot *s, double *re, double *im) 
+{
+	int64_t start, j, k, nk, set, a, b, n = spectrum_n;
+	double mean[NUM_SETS], xr, xi, yr, yi;
+	long double (*block)[NUM_SETS];
+	double (*power)[NUM_SETS];
+
+	s->blocks = 0;
+
+	for (start = first; start < last && start + n <= plan.samples; start += n / 2) {
+		block = &s->ans[start - first];
+		power = &s->power[s->blocks * (n / 2 + 1)];
+
+		for (set = 0; set < NUM_SETS; set++) {
+			mean[set] = 0.0;
+			if (!(set_mask & (1 << set)))
+				continue;
+			for (j = 0; j < n; j++)
+				mean[set] += block[j][set];
+			mean[set] /= n;
+		}
+
+		for (a = 0; a < NUM_SETS; a = b + 1) {
+			while (a < NUM_SETS && !(set_mask & (1 << a)))
+				a++;
+			for (b = a + 1; b < NUM_SETS && !(set_mask & (1 << b)); b++)
+				;
+			if (a == NUM_SETS)
 				break;
-			
-			last_sum = sum;
-			sum += div_power (v (mult_power (x, i), number_set), i);
-			
-		} while ((sum == 0.0) || (sum > last_sum));
+
+			for (j = 0; j < n; j++) {
+				re[j] = (block[j][a] - mean[a]) * hann[j];
+				im[j] = b < NUM_SETS ? (block[j][b] - mean[b]) * hann[j] : 0.0;
+			}
+			fft (re, im);
+
+			for (k = 0; k <= n / 2; k++) {
+				nk = (n - k) % n;
+				xr = (re[k] + re[nk]) / 2;
+				xi = (im[k] - im[nk]) / 2;
+				yr = (im[k] + im[nk]) / 2;
+				yi = (re[nk] - re[k]) / 2;
+				power[k][a] = xr * xr + xi * xi;
+				if (b < NUM_SETS)
+					power[k][b] = yr * yr + yi * yi;
+			}
+		}
+		s->blocks++;
 	}
-  
-	/*  dividing by 64^3 gives values consistent with the Apple // version
-	*  and provides more convenient y-axis labels
-	*/ 
-	sum = div_power (sum, 3);
-  
-	// Done : Reset everything for next run
-	lockstruct.ans3 = sum;
-	lockstruct._lock3 = false;
-	goto threestart;
-	
-	return 0;
 }
 
 
 
-/*  x is number of days to zero date  */ 
+/*  One-sided power spectral density, in value^2 per cycle per day: the
+ *  mean |X(k)|^2 over the blocks, divided by the sample rate and the
+ *  power of the window, doubled for the frequencies between 0 and the
+ *  Nyquist frequency, which stand for their negative twins too.
+ */
 /*--------------*/ 
-void * fFOUR (void) 
+void spectrum_print (double (*power)[NUM_SETS], int64_t blocks) 
+{
+	int64_t k, set;
+	long double scale;
+
+	printf ("\nPower spectral density of %ld blocks of %ld samples from %.*Lf to %.*Lf days to zero", 
+		blocks, spectrum_n, PREC, sample_dtz (0), PREC, sample_dtz (plan.samples - 1));
+	if (window > 0)
+		printf (" (%s over %.*Lf days)", want_average ? "means" : "integrals", PREC, window);
+	printf ("\nFrequency (cycles per day)%s\n", set_list);
+
+	for (k = 0; k <= spectrum_n / 2; k++) {
+		scale = step / (hann_power * blocks);
+		if (k > 0 && k < spectrum_n / 2)
+			scale *= 2;
+		printf ("\n%.*Lf ,", PREC, k / (spectrum_n * step));
+		for (set = 0; set < NUM_SETS; set++)
+			if (set_mask & (1 << set))
+				printf ("%.*Le ,", PREC, power[k][set] * scale);
+	}
+	printf ("\n");
+}
+
+
+
+/*  Start the clock of the run and the monitor thread, which sleeps until
+ *  SIGUSR1, the next rewrite of stats= or the end of the run  */
+/*--------------*/ 
+void start_monitor (void) 
+{
+	struct sigaction sa;
+	int64_t i;
+
+	for (i = 0; i < plan.threads; i++)
+		telemetry[i].current = -1;
+	run_start = now ();
+
+	sem_init (&monitor_wake, 0, 0);
+	memset (&sa, 0, sizeof (sa));
+	sa.sa_handler = on_usr1;
+	sa.sa_flags = SA_RESTART;
+	sigaction (SIGUSR1, &sa, NULL);
+
+	pthread_create (&monitor_thread, NULL, monitor, NULL);
+}
+
+
+
+/*  After the workers: write the final stats= report and stop the monitor  */
+/*--------------*/ 
+void stop_monitor (void) 
+{
+	__atomic_store_n (&monitor_done, TRUE, __ATOMIC_RELAXED);
+	sem_post (&monitor_wake);
+	pthread_join (monitor_thread, NULL);
+	signal (SIGUSR1, SIG_IGN);
+}
+
+
+
+//  sem_post is async-signal-safe, printing is not: the monitor prints
+/*--------------*/ 
+void on_usr1 (int sig) 
+{
+	sem_post (&monitor_wake);
+}
+
+
+
+/*--------------*/ 
+void *monitor (void *arg) 
+{
+	long double next = now () + stats_every, wait;
+	struct timespec deadline;
+	char *temp = NULL;
+	FILE *out;
+
+	if (stats_path && (temp = malloc (strlen (stats_path) + 5)) != NULL)
+		sprintf (temp, "%s.tmp", stats_path);
+
+	for (;;) {
+		wait = stats_path ? fmaxl (next - now (), 0.0) : 3600;
+		clock_gettime (CLOCK_REALTIME, &deadline);
+		deadline.tv_sec += (time_t) wait;
+		deadline.tv_nsec += (long) ((wait - floorl (wait)) * 1e9L);
+		if (deadline.tv_nsec >= 1000000000) {
+			deadline.tv_sec++;
+			deadline.tv_nsec -= 1000000000;
+		}
+
+		if (sem_timedwait (&monitor_wake, &deadline) == 0) {
+			if (!__atomic_load_n (&monitor_done, __ATOMIC_RELAXED)) {
+				report (stderr);
+				continue;
+			}
+		} else if (errno != ETIMEDOUT)
+			continue;
+
+		// Write the whole report aside, then swap it in, so readers of
+		// the file never see half of one
+		if (temp && (out = fopen (temp, "w")) != NULL) {
+			report (out);
+			if (fclose (out) || rename (temp, stats_path))
+				perror (stats_path);
+		}
+		next = now () + stats_every;
+
+		if (__atomic_load_n (&monitor_done, __ATOMIC_RELAXED))
+			break;
+	}
+
+	free (temp);
+	return NULL;
+}
+
+
+
+/*  Progress, rate and ETA of the run so far, and what each worker is doing  */
+/*--------------*/ 
+void report (FILE *out) 
+{
+	long double elapsed = now () - run_start, rate;
+	int64_t i, done = 0, bytes = __atomic_load_n (&printed_bytes, __ATOMIC_RELAXED), current;
+	int64_t samples[MAX_THREADS];
+
+	for (i = 0; i < plan.threads; i++) {
+		samples[i] = __atomic_load_n (&telemetry[i].samples, __ATOMIC_RELAXED);
+		done += samples[i];
+		bytes += __atomic_load_n (&telemetry[i].bytes, __ATOMIC_RELAXED);
+	}
+	rate = elapsed > 0 ? done / elapsed : 0.0;
+
+	fprintf (out, "Progress: %ld of %ld samples (%.1Lf%%) in %.1Lf seconds\n", done, plan.samples, 
+		plan.samples ? 100.0L * done / plan.samples : 100.0L, elapsed);
+	fprintf (out, "Rate: %.0Lf samples/s, ETA ", rate);
+	if (rate > 0)
+		fprintf (out, "%.1Lf seconds\n", (plan.samples - done) / rate);
+	else
+		fprintf (out, "unknown\n");
+	fprintf (out, "Output: %ld bytes\n", bytes);
+
+	for (i = 0; i < plan.threads; i++) {
+		current = __atomic_load_n (&telemetry[i].current, __ATOMIC_RELAXED);
+		fprintf (out, "Thread %ld: %ld samples, %.1Lf%% busy, ", i, samples[i], 
+			elapsed > 0 ? __atomic_load_n (&telemetry[i].busy_ns, __ATOMIC_RELAXED) / (elapsed * 1e7L) : 0.0L);
+		if (current >= 0)
+			fprintf (out, "at dtz %.*Lf\n", PREC, sample_dtz (current));
+		else
+			fprintf (out, "idle\n");
+	}
+	fflush (out);
+}
+
+
+
+/*  Integral of the wave from a to b (0 <= a <= b) in closed form.  Every
+ *  term is linear on its w[] segment: a coarse term p*v(x/p) integrates to
+ *  p^2 times an integral of v(), over the part of [a, b] where f() uses the
+ *  level (x >= p), and a fine term v(x*p)/p to one over p^2.  The fine
+ *  levels are summed until the rest of the series cannot change the sum,
+ *  rather than stopping where f() does, so this is the integral of the
+ *  full series.
+ */
+/*--------------*/ 
+long double f_integral (long double a, long double b, int64_t number_set) 
 {
-	fourstart:
-	;			// This semicolon is required on GCC and ignored elsewhere
-	
-	// Wait until the lock is un-set, then run
-	do {
-		// Do Nothing
-	} while (false == lockstruct._lock4);
-  
-	int64_t number_set = 3;
 	uint64_t i;
-	long double sum = 0.0, last_sum = 0.0;
-	long double x = lockstruct.x4;
-	
-	if (x) {
-	    for (i = 0; x >= powers[i]; i++)
-			sum += mult_power (v (div_power (x, i), number_set), i);
-    
-		i = 0;
-		do {
-			if (++i > CALC_PREC + 2)
-				break;
+	long double sum = 0.0, lo;
 
-		last_sum = sum;
-		sum += div_power (v (mult_power (x, i), number_set), i);      
-		
-		} while ((sum == 0.0) || (sum > last_sum));
-    }
-  
-  
-	/*  dividing by 64^3 gives values consistent with the Apple // version
-	*  and provides more convenient y-axis labels
-	*/ 
-	sum = div_power (sum, 3);
-  
-	// Done : Reset everything for next run
-	lockstruct.ans4 = sum;
-	lockstruct._lock4 = false;
-	goto fourstart;
-	
-	return 0;
-  
+	if (b <= a)
+		return 0.0;
+
+	for (i = 0; i < NUM_POWERS && b > powers[i]; i++) {
+		lo = a > powers[i] ? a : powers[i];
+		sum += mult_power (mult_power (v_integral (div_power (lo, i), div_power (b, i), number_set), i), i);
+	}
+
+	for (i = 1; i < NUM_POWERS; i++) {
+		sum += div_power (div_power (v_integral (mult_power (a, i), mult_power (b, i), number_set), i), i);
+
+		// the levels below this one add at most (b - a) * w_max / (powers[i] * (wf - 1))
+		if (div_power ((b - a) * w_max[number_set], i) <= sum * (wave_factor - 1) * LDBL_EPSILON)
+			break;
+	}
+
+	return div_power (sum, 3);
 }
 
 
 
+/*  Integral of v() from ya to yb (0 <= ya <= yb): whole periods of the
+ *  table plus the pieces at the ends, which stays exact for huge y  */
 /*--------------*/ 
-long double v (long double y, int64_t number_set) 
+ALWAYS_INLINE long double v_integral (long double ya, long double yb, int64_t number_set) 
 {
-  
-	int64_t i = (int64_t) (fmod (y, (long double) NUM_DATA_POINTS));
+	long double ra = fmodl (ya, (long double) NUM_DATA_POINTS);
+	long double rb = fmodl (yb, (long double) NUM_DATA_POINTS);
+	long double periods = ((yb - rb) - (ya - ra)) / NUM_DATA_POINTS;
+
+	return periods * w_prefix[number_set][NUM_DATA_POINTS] + v_prefix (rb, number_set) - v_prefix (ra, number_set);
+}
+
+
+
+/*  Integral of v() from 0 to y, 0 <= y < NUM_DATA_POINTS  */
+/*--------------*/ 
+ALWAYS_INLINE long double v_prefix (long double y, int64_t number_set) 
+{
+	int64_t i = (int64_t) y;
 	int64_t j = (i + 1) % NUM_DATA_POINTS;
-	long double z = y - floor (y);
-  
-	return (z == 0.0 ? (long double) w[number_set][i] : 
-		(w[number_set][j] - w[number_set][i]) * z + w[number_set][i]);
-  
-} 
+	long double z = y - i;
+
+	return w_prefix[number_set][i] + twz_w[number_set][i] * z + (twz_w[number_set][j] - twz_w[number_set][i]) * z * z / 2;
+}
+
 
 
 /*  in order to speed up the calculation, if wave factor = 64
@@ -489,7 +1889,7 @@ long double v (long double y, int64_t number_set)
  */ 
 
 /*-----------------------*/ 
-long double mult_power (long double x, int64_t i) 
+ALWAYS_INLINE long double mult_power (long double x, int64_t i) 
 {
 	/* Removing this code: Switching to 64-bit datatypes
 	int64_t *exponent = (int64_t *) &x + 3;
@@ -503,7 +1903,7 @@ long double mult_power (long double x, int64_t i)
 
 
 /*----------------------*/ 
-long double div_power (long double x, int64_t i) 
+ALWAYS_INLINE long double div_power (long double x, int64_t i) 
 {
 	/* Removing this code: Switching to 64-bit datatypes
 	int64_t *exponent = (int64_t *) &x + 3;
@@ -552,12 +1952,20 @@ void get_wave_factor (void)
 } 
 
 
-int64_t doublecheck (void) 
+/*  Ask before starting a job that exceeds the budget; there is nobody to
+ *  ask when the input is not a terminal  */
+int64_t doublecheck (long double budget) 
 {
-	char answer;
+	char answer = 'N';
   
-	printf("\nThe combination you have chosen will create %Lf data points. \nDo you wish to continue? (Y/N) ", 1 + (int) dtzp / step);
-	answer = getchar ();
+	if (!isatty (STDIN_FILENO))
+		return FALSE;
+
+	fprintf (stderr, "\nThe combination you have chosen will create %ld data points in about %.0Lf seconds (budget %.0Lf). \nDo you wish to continue? (Y/N) ", 
+		plan.samples, plan.seconds, budget);
+	int64_t temp = scanf (" %c", &answer);
+
+	return (answer == 'Y' || answer == 'y');
 } 
 
 void inputerror (void) 
@@ -566,3 +1974,4 @@ void inputerror (void)
 	exit (EXIT_SUCCESS);
 } 
 
+
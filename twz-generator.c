@@ -51,19 +51,35 @@ For more information, please refer to <http://unlicense.org/>
 #include <stdint.h>
 #include <string.h>
 
+#include "twz-kernel.h"
+
 
 #define FALSE 0
 #define TRUE  1
-#define NUM_POWERS 64
+#define NUM_POWERS TWZ_POWERS
 #define PREC 16 // long double (80 bit) numbers have about 16 significant digits  INTEL / AMD / x86_64
 //#define PREC 32 // long double (128 bit) numbers have about 32 significant digits (QUAD PRECISION)
-#define NUM_SETS 4
-#define NUM_DATA_POINTS 384
-#define CALC_PREC       1000000  //  precision in calculation of wave values
+#define NUM_SETS TWZ_SETS
+#define MAX_BINS 1000
 
 
 long double powers[NUM_POWERS];
 
+/*  Running statistics of a stretch of samples (reduce mode).  The means
+ *  and the co-moments c[a][b] = sum (x_a - mean_a)(x_b - mean_b) are
+ *  updated one sample at a time (Welford), and two stretches merge exactly
+ *  (Chan et al.); twz-generator-threaded merges the chunks of its workers.
+ */
+struct Stats 
+{
+	int64_t n;
+	long double min[NUM_SETS], max[NUM_SETS];
+	long double min_at[NUM_SETS], max_at[NUM_SETS];	//  dtz of the first minimum and maximum
+	long double mean[NUM_SETS];
+	long double c[NUM_SETS][NUM_SETS];
+	int64_t hist[NUM_SETS][MAX_BINS + 2];	//  below hist_lo, the bins, from hist_hi up
+};
+
 //  Powers of (normally) 64.
 //  Due to the limitations of double precision
 //  floating point arithmetic these values are
@@ -73,10 +89,24 @@ int64_t wave_factor = 64;		//  default wave factor
 int64_t number_set, stringchar;
 
 
-char *usage = "\nUsage: twz [dtz] [neg] [step] [wf]." 
+//  Reduce mode: print only the statistics of the window, with a histogram
+//  of hist_bins bins from hist_lo to hist_hi when hist_bins is not 0
+int64_t want_reduce = FALSE, hist_bins = 0;
+long double hist_lo, hist_hi;
+
+
+char *usage = "\nUsage: twz [dtz] [neg] [step] [wf] [options]." 
 "\n dtz = days to zero-point" 
 "\n step = steps in which to decrement time (in minutes)" 
 "\n wf = wave factor (default 64, range 2-10000)" 
+"\n\nOptions:"
+"\n slope = also print the slope of each set (per day of dtz) of the levels"
+"\n         f() adds up; it leaves out the finer ones (see README)" 
+"\n reduce = print only the minimum, maximum, mean and variance of each set"
+"\n          and the correlations between them, not the samples"
+"\n hist=n,lo,hi = reduce, with a histogram of n bins from lo to hi"
+"\n sets=list = calculate and print only the number sets listed, e.g. 1,3 for"
+"\n             Kelley and Sheliak (default all)"
 "\n\nThis program calculates the running values of the timewave within the given window.\n";
 
 
@@ -85,56 +115,71 @@ char *set_name[NUM_SETS] =
 { "Kelley", "Watkins", "Sheliak", "Huang Ti" };
 
 
-char *title = "Days to Zero (DTZ), Kelley, Watkins, Sheliak, Huang Ti";
-
-
-//  The number sets.
-int64_t w[NUM_SETS][NUM_DATA_POINTS] = 
-{ 
-	{
-	#include "DATA/DATA.TW1"		//  half-twist
-	}, 
-	{
-	#include "DATA/DATA.TW2"		//  no half-twist
-	}, 
-	{
-	#include "DATA/DATA.TW3"		//  Sheliak 
-	}, 
-	{
-	#include "DATA/DATA.TW4"		//  HuangTi (no half-twist)
-	} 
-};
+//  Only the sets in set_mask (sets=, all by default) are calculated and
+//  printed; set_list is their part of the titles (", Kelley, ...")
+int64_t set_mask = (1 << NUM_SETS) - 1;
+char set_list[128], title[256], slope_title[256];
+
 
 void inputerror (void);
 void get_dtzp (void);
 void get_NegBailout (void);
 void get_step (void);
 void get_wave_factor (void);
-void set_powers (void);
+int64_t parse_sets (char *s);
+void set_columns (void);
+void stats_clear (struct Stats *s);
+void stats_add (struct Stats *s, long double x, long double *ans);
+void stats_print (struct Stats *s);
 
-long double f (long double x, int64_t number_set);
 long double fONE (long double x);
 long double fTWO (long double x);
 long double fTHREE (long double x);
 long double fFOUR (long double x);
 
-long double v (long double y, int64_t number_set);
-long double mult_power (long double x, int64_t i);
-long double div_power (long double x, int64_t i);
 long double dtzp, NegativeBailout, step;
 
 
 /*-----------------------------*/ 
 int main (int argc, char *argv[]) 
 {
-	int64_t i, j, ch;
+	int64_t i, j, ch, want_slope = FALSE;
+	long double value, slope, ans[NUM_SETS], first, last;
+	struct Stats *total = NULL;
 
-	if (argc != 5 && argc != 1) {
+	if (argc < 5 && argc != 1) {
 		printf ("%s", usage);
 		inputerror ();
 	}
+
+	for (i = 5; i < argc; i++) {
+		if (!strcmp (argv[i], "slope")) {
+			want_slope = TRUE;
+		} else if (!strcmp (argv[i], "reduce")) {
+			want_reduce = TRUE;
+		} else if (!memcmp (argv[i], "hist=", 5)) {
+			want_reduce = TRUE;
+			if (sscanf (&argv[i][5], "%ld,%Lf,%Lf", &hist_bins, &hist_lo, &hist_hi) != 3 
+				|| hist_bins < 1 || hist_bins > MAX_BINS || hist_hi <= hist_lo)
+				inputerror ();
+		} else if (!memcmp (argv[i], "sets=", 5)) {
+			set_mask = parse_sets (&argv[i][5]);
+			if (!set_mask)
+				inputerror ();
+		} else {
+			printf ("%s", usage);
+			inputerror ();
+		}
+	}
+
+	if (want_reduce) {
+		total = malloc (sizeof (struct Stats));
+		if (want_slope || total == NULL)
+			inputerror ();
+		stats_clear (total);
+	}
   
-	if (argc == 5) {
+	if (argc >= 5) {
 
 		dtzp = atof (&argv[1][0]);
     
@@ -160,127 +205,199 @@ int main (int argc, char *argv[])
 		get_wave_factor();
 	}
 
-	set_powers();
+	twz_powers (powers, wave_factor);
+	set_columns ();
 
 	//printf("\n\ndtzp: %lfstep: %lfwave_factor: %d",dtzp, step, wave_factor);
-	printf ("\n%s\n", title);
+	// The reduce header follows the loop, once the samples are counted
+	if (!want_reduce)
+		printf ("\n%s\n", want_slope ? slope_title : title);
 	
+	first = last = dtzp;
 	while (dtzp >= NegativeBailout) {
+		if (want_reduce) {
+			for (number_set = 0; number_set < NUM_SETS; number_set++)
+				if (set_mask & (1 << number_set))
+					ans[number_set] = twz_f (dtzp, twz_w[number_set], powers);
+			stats_add (total, dtzp, ans);
+			last = dtzp;
+			dtzp -= step;
+			continue;
+		}
+
 		printf ("%.*Lf ,", PREC, dtzp);
 		
 		for (number_set = 0; number_set < NUM_SETS; number_set++) {
-			printf ("%.*Lf ,", PREC, f (dtzp, number_set));
+			if (!(set_mask & (1 << number_set)))
+				continue;
+			if (want_slope) {
+				value = twz_f_slope (dtzp, twz_w[number_set], powers, &slope);
+				printf ("%.*Lf ,%.*Lf ,", PREC, value, PREC, slope);
+			} else
+				printf ("%.*Lf ,", PREC, twz_f (dtzp, twz_w[number_set], powers));
 		}
 	    printf ("\n");
 	    dtzp -= step;
 	}
-	
+
+	if (want_reduce) {
+		printf ("\nSummary of %ld samples from %.*Lf to %.*Lf days to zero\n", total->n, 
+			PREC, first, PREC, last);
+		stats_print (total);
+	}
 }
 
 
 
-//  wave_factor is a global variable
-/*-----------------*/ 
-void set_powers (void) 
+/*--------------*/ 
+void stats_clear (struct Stats *s) 
 {
-	uint64_t j;
-  
-	/*  put powers[j] = wave_factor^j  */ 
-	powers[0] = (long double) 1;
-  
-	for (j = 1; j < NUM_POWERS; j++)
-	    powers[j] = wave_factor * powers[j - 1];
+	memset (s, 0, sizeof (struct Stats));
 }
 
 
 
-/*  x is number of days to zero date  */ 
+/*  Add the values ans of the selected sets at dtz x  */
 /*--------------*/ 
-long double f (long double x, int64_t number_set) 
+void stats_add (struct Stats *s, long double x, long double *ans) 
 {
-	uint64_t i;
-	long double sum = 0.0, last_sum = 0.0;
-  
-	if (x) {
-    
-		for (i = 0; x >= powers[i]; i++)
-			sum += mult_power (v (div_power (x, i), number_set), i);
-		
-		i = 0;
-		do {
-			if (++i > CALC_PREC + 2)
-				break;
-      
-			last_sum = sum;
-			sum += div_power (v (mult_power (x, i), number_set), i);
-	
-		} while ((sum == 0.0) || (sum > last_sum));
-    
+	int64_t a, b, bin;
+	long double delta[NUM_SETS];
+
+	s->n++;
+	for (a = 0; a < NUM_SETS; a++) {
+		if (!(set_mask & (1 << a)))
+			continue;
+		if (s->n == 1 || ans[a] < s->min[a]) {
+			s->min[a] = ans[a];
+			s->min_at[a] = x;
+		}
+		if (s->n == 1 || ans[a] > s->max[a]) {
+			s->max[a] = ans[a];
+			s->max_at[a] = x;
+		}
+		delta[a] = ans[a] - s->mean[a];
+		s->mean[a] += delta[a] / s->n;
 	}
-  
-	/*  dividing by 64^3 gives values consistent with the Apple // version
-	*  and provides more convenient y-axis labels
-	*/ 
-	sum = div_power (sum, 3);
-	return (sum);
-}
 
+	for (a = 0; a < NUM_SETS; a++)
+		for (b = 0; b < NUM_SETS; b++)
+			if (set_mask & (1 << a) && set_mask & (1 << b))
+				s->c[a][b] += delta[a] * (ans[b] - s->mean[b]);
+
+	if (hist_bins)
+		for (a = 0; a < NUM_SETS; a++) {
+			if (!(set_mask & (1 << a)))
+				continue;
+			if (ans[a] < hist_lo)
+				bin = 0;
+			else if (ans[a] >= hist_hi)
+				bin = hist_bins + 1;
+			else
+				bin = 1 + (int64_t) ((ans[a] - hist_lo) / (hist_hi - hist_lo) * hist_bins);
+			if (bin > hist_bins)		//  rounding just below hist_hi
+				bin = hist_bins;
+			s->hist[a][bin]++;
+		}
+}
 
 
 
+/*  The summary: one row per set, the correlation matrix and the histogram.
+ *  The variance is that of the samples of the window (divided by n).  */
 /*--------------*/ 
-long double v (long double y, int64_t number_set) 
+void stats_print (struct Stats *s) 
 {
-  
-	int64_t i = (int64_t) (fmod (y, (long double) NUM_DATA_POINTS));
-  
-	int64_t j = (i + 1) % NUM_DATA_POINTS;
-  
-	long double z = y - floor (y);
-  
-	return (z == 0.0 ? (long double) w[number_set][i] : 
-		(w[number_set][j] - w[number_set][i]) * z + w[number_set][i]);
-} 
+	int64_t a, b, bin;
+
+	printf ("\nSet, Minimum, at DTZ, Maximum, at DTZ, Mean, Variance, Standard deviation");
+	for (a = 0; a < NUM_SETS; a++) {
+		if (!(set_mask & (1 << a)))
+			continue;
+		printf ("\n%s ,", set_name[a]);
+		if (s->n == 0)
+			continue;
+		printf ("%.*Lf ,%.*Lf ,%.*Lf ,%.*Lf ,%.*Lf ,%.*Le ,%.*Le ,", PREC, s->min[a], PREC, s->min_at[a], 
+			PREC, s->max[a], PREC, s->max_at[a], PREC, s->mean[a], PREC, s->c[a][a] / s->n, 
+			PREC, sqrtl (s->c[a][a] / s->n));
+	}
 
+	printf ("\n\nCorrelation%s", set_list);
+	for (a = 0; a < NUM_SETS; a++) {
+		if (!(set_mask & (1 << a)))
+			continue;
+		printf ("\n%s ,", set_name[a]);
+		for (b = 0; b < NUM_SETS; b++)
+			if (set_mask & (1 << b))
+				printf ("%.*Lf ,", PREC, s->c[a][b] / sqrtl (s->c[a][a] * s->c[b][b]));
+	}
 
-/*  in order to speed up the calculation, if wave factor = 64
-*  then instead of using multiplication or division operation
-*  we act directly on the floating point representation;
-*  multiplying by 64^i is accomplished by adding i*0x60
-*  to the exponent (the last 2 bytes of the 8-byte representation);
-*  dividing by 64^i is accomplished by subtracting i*0x60
-*  from the exponent
-*/ 
+	if (hist_bins) {
+		printf ("\n\nFrom, To%s", set_list);
+		for (bin = 0; bin < hist_bins + 2; bin++) {
+			if (bin == 0)
+				printf ("\n-inf ,%.*Lf ,", PREC, hist_lo);
+			else if (bin > hist_bins)
+				printf ("\n%.*Lf ,inf ,", PREC, hist_hi);
+			else
+				printf ("\n%.*Lf ,%.*Lf ,", PREC, hist_lo + (hist_hi - hist_lo) * (bin - 1) / hist_bins, 
+					PREC, hist_lo + (hist_hi - hist_lo) * bin / hist_bins);
+			for (a = 0; a < NUM_SETS; a++)
+				if (set_mask & (1 << a))
+					printf ("%ld ,", s->hist[a][bin]);
+		}
+	}
+	printf ("\n");
+}
 
-/*-----------------------*/ 
-long double mult_power (long double x, int64_t i) 
+
+
+//  "all" or a list of set numbers "1,3"
+/*--------------*/
+int64_t parse_sets (char *s)
 {
-	/* Removing this code: Switching to 64-bit datatypes
-	int *exponent = (int *) &x + 3;
-	if (wave_factor == 64)
-		*exponent += i * 0x60; //   measurably faster  
-	else
-	*/    
-		x *= powers[i];
-	return (x);
+	int64_t sets = 0, n;
+	char *p;
+
+	if (!strcmp (s, "all"))
+		return (1 << NUM_SETS) - 1;
+
+	for (p = s; *p; ) {
+		n = strtol (p, &p, 10);
+		if (n < 1 || n > NUM_SETS)
+			return 0;
+		sets |= 1 << (n - 1);
+		if (*p == ',')
+			p++;
+		else if (*p)
+			return 0;
+	}
+
+	return sets;
 }
 
 
 
-/*----------------------*/ 
-long double div_power (long double x, int64_t i) 
+/*  Build the titles of the columns of the sets in set_mask  */
+/*-----------------*/ 
+void set_columns (void) 
 {
-	/* Removing this code: Switching to 64-bit datatypes
-	int *exponent = (int *) &x + 3;
-	if ((wave_factor == 64) && (*exponent > i * 0x60))
-		*exponent -= i * 0x60;
-	else */
-	    x /= powers[i];
-	
-	return (x);
+	int64_t set, n = 0, m = 0;
+	char slope_list[256];
+
+	set_list[0] = slope_list[0] = '\0';
+	for (set = 0; set < NUM_SETS; set++)
+		if (set_mask & (1 << set)) {
+			n += snprintf (set_list + n, sizeof (set_list) - n, ", %s", set_name[set]);
+			m += snprintf (slope_list + m, sizeof (slope_list) - m, ", %s, slope", set_name[set]);
+		}
+
+	snprintf (title, sizeof (title), "Days to Zero (DTZ)%s", set_list);
+	snprintf (slope_title, sizeof (slope_title), "Days to Zero (DTZ)%s", slope_list);
 }
 
 
+
 void get_dtzp (void) 
 {
 	printf ("Enter the number of days before zero point:  ");
@@ -0,0 +1,515 @@
+//  twz-jobs.c
+//
+// Based on source code by the original author: Peter Meyer
+//  Run many generator windows from one job file, evaluating every point
+//  that several windows share only once, using multiple threads.
+
+// Written for the Linux port
+// 19 Oct 2026
+
+/*
+
+This is free and unencumbered software released into the public domain.
+
+Anyone is free to copy, modify, publish, use, compile, sell, or
+distribute this software, either in source code form or as a compiled
+binary, for any purpose, commercial or non-commercial, and by any
+means.
+
+In jurisdictions that recognize copyright laws, the author or authors
+of this software dedicate any and all copyright interest in the
+software to the public domain. We make this dedication for the benefit
+of the public at large and to the detriment of our heirs and
+successors. We intend this dedication to be an overt act of
+relinquishment in perpetuity of all present and future rights to this
+software under copyright law.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+
+For more information, please refer to <http://unlicense.org/>
+
+09 Dec 2012
+*/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <pthread.h>
+
+#include "twz-kernel.h"
+
+
+#define FALSE 0
+#define TRUE  1
+#define NUM_POWERS TWZ_POWERS
+#define PREC 16 // long double (80 bit) numbers have about 16 significant digits  INTEL / AMD / x86_64
+//#define PREC 32 // long double (128 bit) numbers have about 32 significant digits (QUAD PRECISION)
+#define NUM_SETS TWZ_SETS
+#define MAX_THREADS 256
+#define MAX_JOBS 4096
+#define MAX_LINE 4096
+#define BATCH (1 << 16)			//  distinct points evaluated between two fan-outs
+#define BATCH_REFS (4 * BATCH)	//  (job, point) pairs per batch
+#define CHUNK 1024				//  points per task
+#define TICKS_PER_DAY 86400000000.0L	//  the shared grid is in microseconds
+
+
+/*  One window of the job file.  Jobs on the grid have their samples at
+ *  first - n * stride microseconds to zero, so two of them share a point
+ *  exactly when the integers match; the others (dtz or step not a whole
+ *  number of microseconds) are evaluated on their own at dtz - n * step.
+ */
+struct Job
+{
+	long double dtz, neg, step;	//  days
+	int64_t wave_factor;
+	int64_t sets;				//  bit i for number set i
+	int64_t on_grid;
+	int64_t first, stride;		//  ticks
+	int64_t count, next;		//  samples, and the next one to merge
+	int64_t grouped;
+	char *output;
+	FILE *out;
+};
+
+/*  A distinct point of the current batch and the jobs it goes to  */
+struct Point
+{
+	long double x;
+	int64_t sets;				//  union of the sets of its jobs
+	int64_t refs, num_refs;		//  its jobs are ref[refs .. refs + num_refs - 1]
+	long double ans[NUM_SETS];
+};
+
+
+char *usage = "\nUsage: twz-jobs [jobfile] [threads=nn]."
+"\n jobfile = one job per line (- for standard input):"
+"\n           dtz neg step wf sets output"
+"\n   dtz, neg, step, wf = as for twz-generator (step in minutes); the wave is only"
+"\n                        defined before zero, so windows are cut off at the zero point"
+"\n   sets = all, or a list of set numbers like 1,3"
+"\n          (1 Kelley, 2 Watkins, 3 Sheliak, 4 Huang Ti)"
+"\n   output = CSV file of the job (- for standard output)"
+"\n   Lines starting with # are comments."
+"\n threads = number of calculation threads (default: all processors)"
+"\n\nThis program runs every window of the job file, calculating each point that"
+"\nwindows with the same wave factor share only once.\n";
+
+
+char *set_name[NUM_SETS] =
+{ "Kelley", "Watkins", "Sheliak", "Huang Ti" };
+
+
+struct Job *jobs;
+int64_t num_jobs;
+struct Point *points;
+int64_t *ref;
+int64_t num_points, num_threads, next_task;
+pthread_mutex_t next_lock = PTHREAD_MUTEX_INITIALIZER;
+
+long double powers[NUM_POWERS];	//  of the wave factor of the current group
+
+
+void inputerror (void);
+int64_t read_jobs (FILE *in);
+int64_t parse_sets (char *s);
+void run_group (int64_t *group, int64_t size);
+void evaluate_batch (void);
+void fan_out (void);
+int64_t job_key (struct Job *j);
+void heap_push (int64_t *heap, int64_t *size, int64_t job);
+int64_t heap_pop (int64_t *heap, int64_t *size);
+void *worker (void *arg);
+
+
+int64_t requested = 0, evaluated = 0;
+
+
+/*-----------------------------*/
+int main (int argc, char *argv[])
+{
+	int64_t i, k, size, set;
+	int64_t *group;
+	FILE *in;
+
+	if (argc < 2) {
+		printf ("%s", usage);
+		inputerror ();
+	}
+
+	num_threads = sysconf (_SC_NPROCESSORS_ONLN);
+
+	for (i = 2; i < argc; i++) {
+		if (!memcmp (argv[i], "threads=", 8))
+			num_threads = atoi (&argv[i][8]);
+		else {
+			printf ("%s", usage);
+			inputerror ();
+		}
+	}
+
+	if (num_threads < 1)
+		num_threads = 1;
+	if (num_threads > MAX_THREADS)
+		num_threads = MAX_THREADS;
+
+	in = strcmp (argv[1], "-") ? fopen (argv[1], "r") : stdin;
+	if (in == NULL) {
+		printf ("\nError: Cannot open %s, exiting.\n\n", argv[1]);
+		exit (EXIT_FAILURE);
+	}
+
+	jobs = malloc (MAX_JOBS * sizeof (struct Job));
+	points = malloc (BATCH * sizeof (struct Point));
+	ref = malloc (BATCH_REFS * sizeof (int64_t));
+	group = malloc (MAX_JOBS * sizeof (int64_t));
+	if (jobs == NULL || points == NULL || ref == NULL || group == NULL) {
+		printf ("\nError: Out of memory, exiting.\n\n");
+		exit (EXIT_FAILURE);
+	}
+
+	if (!read_jobs (in)) {
+		printf ("%s", usage);
+		inputerror ();
+	}
+	if (in != stdin)
+		fclose (in);
+
+	// Open every output and write its title
+	for (i = 0; i < num_jobs; i++) {
+		for (k = 0; k < i && strcmp (jobs[k].output, jobs[i].output); k++)
+			;
+		if (k < i && strcmp (jobs[i].output, "-")) {
+			printf ("\nError: jobs %ld and %ld both write %s, exiting.\n\n", k + 1, i + 1, jobs[i].output);
+			exit (EXIT_FAILURE);
+		}
+
+		jobs[i].out = strcmp (jobs[i].output, "-") ? fopen (jobs[i].output, "w") : stdout;
+		if (jobs[i].out == NULL) {
+			printf ("\nError: Cannot write %s, exiting.\n\n", jobs[i].output);
+			exit (EXIT_FAILURE);
+		}
+
+		fprintf (jobs[i].out, "\nDays to Zero (DTZ)");
+		for (set = 0; set < NUM_SETS; set++)
+			if (jobs[i].sets & (1 << set))
+				fprintf (jobs[i].out, ", %s", set_name[set]);
+		fprintf (jobs[i].out, "\n");
+	}
+
+	// Only jobs on the grid with the same wave factor can share points;
+	// each group is merged and evaluated on its own
+	for (i = 0; i < num_jobs; i++) {
+		if (jobs[i].grouped)
+			continue;
+
+		size = 0;
+		group[size++] = i;
+		for (k = i + 1; jobs[i].on_grid && k < num_jobs; k++)
+			if (!jobs[k].grouped && jobs[k].on_grid && jobs[k].wave_factor == jobs[i].wave_factor) {
+				group[size++] = k;
+				jobs[k].grouped = TRUE;
+			}
+
+		run_group (group, size);
+	}
+
+	for (i = 0; i < num_jobs; i++)
+		if (jobs[i].out != stdout)
+			fclose (jobs[i].out);
+
+	fprintf (stderr, "%ld jobs, %ld samples, %ld points calculated (%.1f%% shared)\n", num_jobs, requested, evaluated,
+		requested ? 100.0 * (requested - evaluated) / requested : 0.0);
+
+	return 0;
+}
+
+
+
+/*  Read the jobs, one per line.  Returns FALSE on a malformed line.  */
+/*--------------*/
+int64_t read_jobs (FILE *in)
+{
+	char line[MAX_LINE], sets[MAX_LINE], output[MAX_LINE];
+	double dtz, neg, minutes;
+	long wf;
+	long double ticks;
+	int64_t lineno = 0;
+	struct Job *j;
+
+	num_jobs = 0;
+	while (fgets (line, sizeof (line), in) != NULL) {
+		lineno++;
+		if (sscanf (line, " %s", sets) != 1 || sets[0] == '#')
+			continue;
+
+		if (num_jobs == MAX_JOBS) {
+			printf ("\nError: more than %d jobs.\n", MAX_JOBS);
+			return FALSE;
+		}
+
+		j = &jobs[num_jobs];
+		if (sscanf (line, "%lf %lf %lf %ld %s %s", &dtz, &neg, &minutes, &wf, sets, output) != 6
+			|| minutes <= 0 || wf < 2 || wf > 10000 || (j->sets = parse_sets (sets)) == 0) {
+			printf ("\nError in line %ld of the job file.\n", lineno);
+			return FALSE;
+		}
+
+		j->dtz = dtz;
+		j->neg = -neg;			//  the end of the window, as NegativeBailout in the generators
+		j->step = minutes / 60 / 24;
+
+		// Past the zero point f() would index the data points below 0
+		if (j->dtz < 0.0)
+			fprintf (stderr, "Job %ld starts after the zero point and is skipped\n", num_jobs + 1);
+		else if (j->neg < 0.0)
+			fprintf (stderr, "Job %ld is calculated to the zero point only\n", num_jobs + 1);
+		if (j->neg < 0.0)
+			j->neg = 0.0;
+		j->wave_factor = wf;
+		j->output = strdup (output);
+		j->next = 0;
+		j->grouped = FALSE;
+		j->count = j->dtz < j->neg ? 0 : (int64_t) floorl ((j->dtz - j->neg) / j->step + 1e-9L) + 1;
+
+		// On the grid when dtz and step are whole microseconds and every
+		// sample fits in an int64_t
+		ticks = j->step * TICKS_PER_DAY;
+		j->stride = llroundl (ticks);
+		j->on_grid = j->stride >= 1 && fabsl (ticks - j->stride) < 1e-3L;
+		ticks = j->dtz * TICKS_PER_DAY;
+		j->on_grid = j->on_grid && fabsl (ticks) < 4e18L && fabsl (j->neg * TICKS_PER_DAY) < 4e18L;
+		if (j->on_grid) {
+			j->first = llroundl (ticks);
+			j->on_grid = fabsl (ticks - j->first) < 1e-3L;
+		}
+		if (!j->on_grid)
+			fprintf (stderr, "Job %ld is not on the microsecond grid and shares no points\n", num_jobs + 1);
+
+		requested += j->count;
+		num_jobs++;
+	}
+
+	return num_jobs > 0;
+}
+
+
+
+//  "all" or a list of set numbers "1,3"
+/*--------------*/
+int64_t parse_sets (char *s)
+{
+	int64_t sets = 0, n;
+	char *p;
+
+	if (!strcmp (s, "all"))
+		return (1 << NUM_SETS) - 1;
+
+	for (p = s; *p; ) {
+		n = strtol (p, &p, 10);
+		if (n < 1 || n > NUM_SETS)
+			return 0;
+		sets |= 1 << (n - 1);
+		if (*p == ',')
+			p++;
+		else if (*p)
+			return 0;
+	}
+
+	return sets;
+}
+
+
+
+/*  Merge the samples of the jobs of a group, largest dtz first, into
+ *  batches of distinct points; evaluate each batch with the pool and
+ *  write every point to all the jobs that have it.  Every job's samples
+ *  come in decreasing order, so its rows are written in order.
+ */
+/*--------------*/
+void run_group (int64_t *group, int64_t size)
+{
+	int64_t heap[MAX_JOBS], heap_size = 0, k, key, jn, num_refs = 0;
+	struct Point *p;
+	struct Job *j;
+
+	twz_powers (powers, jobs[group[0]].wave_factor);
+
+	for (k = 0; k < size; k++)
+		if (jobs[group[k]].count > 0)
+			heap_push (heap, &heap_size, group[k]);
+
+	num_points = 0;
+	while (heap_size > 0) {
+		if (num_points == BATCH || num_refs + size > BATCH_REFS) {
+			evaluate_batch ();
+			fan_out ();
+			num_points = num_refs = 0;
+		}
+
+		// Every job at the largest key shares this point
+		p = &points[num_points++];
+		key = job_key (&jobs[heap[0]]);
+		p->refs = num_refs;
+		p->num_refs = 0;
+		p->sets = 0;
+		while (heap_size > 0 && job_key (&jobs[heap[0]]) == key) {
+			jn = heap_pop (heap, &heap_size);
+			j = &jobs[jn];
+
+			// A sample that rounds to just past the end of the window
+			// (at most the zero point) is taken at the end
+			if (p->num_refs == 0)
+				p->x = fmaxl (j->on_grid ? (j->first - j->next * j->stride) / TICKS_PER_DAY : j->dtz - j->next * j->step, j->neg);
+			p->sets |= j->sets;
+			ref[num_refs++] = jn;
+			p->num_refs++;
+
+			if (++j->next < j->count)
+				heap_push (heap, &heap_size, jn);
+		}
+	}
+
+	evaluate_batch ();
+	fan_out ();
+	num_points = 0;
+}
+
+
+
+/*  Merge key of the next sample of a job: its tick on the grid, or for
+ *  a job off the grid (always alone in its group) just its position  */
+/*--------------*/
+int64_t job_key (struct Job *j)
+{
+	return j->on_grid ? j->first - j->next * j->stride : -j->next;
+}
+
+
+
+/*  Max-heap of job indices on job_key  */
+/*--------------*/
+void heap_push (int64_t *heap, int64_t *size, int64_t job)
+{
+	int64_t i = (*size)++, parent;
+
+	while (i > 0) {
+		parent = (i - 1) / 2;
+		if (job_key (&jobs[heap[parent]]) >= job_key (&jobs[job]))
+			break;
+		heap[i] = heap[parent];
+		i = parent;
+	}
+	heap[i] = job;
+}
+
+/*--------------*/
+int64_t heap_pop (int64_t *heap, int64_t *size)
+{
+	int64_t top = heap[0], last = heap[--(*size)], i = 0, child;
+
+	for (;;) {
+		child = 2 * i + 1;
+		if (child >= *size)
+			break;
+		if (child + 1 < *size && job_key (&jobs[heap[child + 1]]) > job_key (&jobs[heap[child]]))
+			child++;
+		if (job_key (&jobs[last]) >= job_key (&jobs[heap[child]]))
+			break;
+		heap[i] = heap[child];
+		i = child;
+	}
+	heap[i] = last;
+
+	return top;
+}
+
+
+
+/*  Evaluate the points of the batch with the pool  */
+/*--------------*/
+void evaluate_batch (void)
+{
+	int64_t t;
+	pthread_t threads[MAX_THREADS];
+
+	if (num_points == 0)
+		return;
+
+	evaluated += num_points;
+	next_task = 0;
+	for (t = 0; t < num_threads; t++)
+		pthread_create (&threads[t], NULL, worker, NULL);
+	for (t = 0; t < num_threads; t++)
+		pthread_join (threads[t], NULL);
+}
+
+
+
+/*  Write every point of the batch to each of its jobs  */
+/*--------------*/
+void fan_out (void)
+{
+	int64_t n, r, set;
+	struct Point *p;
+	struct Job *j;
+
+	for (n = 0; n < num_points; n++) {
+		p = &points[n];
+		for (r = p->refs; r < p->refs + p->num_refs; r++) {
+			j = &jobs[ref[r]];
+			fprintf (j->out, "%.*Lf ,", PREC, p->x);
+			for (set = 0; set < NUM_SETS; set++)
+				if (j->sets & (1 << set))
+					fprintf (j->out, "%.*Lf ,", PREC, p->ans[set]);
+			fprintf (j->out, "\n");
+		}
+	}
+}
+
+
+
+//  Calculation thread: take chunks of the batch until none are left
+/*--------------*/
+void *worker (void *arg)
+{
+	int64_t task, n, last, number_set;
+	struct Point *p;
+
+	for (;;) {
+		pthread_mutex_lock (&next_lock);
+		task = next_task++;
+		pthread_mutex_unlock (&next_lock);
+
+		if (task * CHUNK >= num_points)
+			break;
+
+		last = (task + 1) * CHUNK < num_points ? (task + 1) * CHUNK : num_points;
+		for (n = task * CHUNK; n < last; n++) {
+			p = &points[n];
+			for (number_set = 0; number_set < NUM_SETS; number_set++)
+				if (p->sets & (1 << number_set))
+					p->ans[number_set] = twz_f (p->x, twz_w[number_set], powers);
+		}
+	}
+
+	return NULL;
+}
+
+
+
+void inputerror (void)
+{
+	printf ("\nError: Invalid input, exiting.\n\n");
+	exit (EXIT_SUCCESS);
+}
@@ -0,0 +1,135 @@
+//  twz-kernel.c
+//
+// Based on source code by the original author: Peter Meyer
+//  The number sets and f() of twz-kernel.h.
+
+// Written for the Linux port
+// 19 Oct 2026
+
+/*
+
+This is free and unencumbered software released into the public domain.
+
+Anyone is free to copy, modify, publish, use, compile, sell, or
+distribute this software, either in source code form or as a compiled
+binary, for any purpose, commercial or non-commercial, and by any
+means.
+
+In jurisdictions that recognize copyright laws, the author or authors
+of this software dedicate any and all copyright interest in the
+software to the public domain. We make this dedication for the benefit
+of the public at large and to the detriment of our heirs and
+successors. We intend this dedication to be an overt act of
+relinquishment in perpetuity of all present and future rights to this
+software under copyright law.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+
+For more information, please refer to <http://unlicense.org/>
+
+09 Dec 2012
+*/
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "twz-kernel.h"
+
+
+#define ALWAYS_INLINE static inline __attribute__ ((always_inline))
+
+
+//  The number sets.
+const int64_t twz_w[TWZ_SETS][TWZ_DATA_POINTS] =
+{
+	{
+	#include "DATA/DATA.TW1"		//  half-twist
+	},
+	{
+	#include "DATA/DATA.TW2"		//  no half-twist
+	},
+	{
+	#include "DATA/DATA.TW3"		//  Sheliak
+	},
+	{
+	#include "DATA/DATA.TW4"		//  HuangTi (no half-twist)
+	}
+};
+
+
+ALWAYS_INLINE long double f (long double x, const int64_t *w, const long double *p, long double *slope);
+
+
+
+/*--------------*/
+void twz_powers (long double p[TWZ_POWERS], int64_t wave_factor)
+{
+	int64_t i;
+
+	p[0] = 1.0L;
+	for (i = 1; i < TWZ_POWERS; i++)
+		p[i] = wave_factor * p[i - 1];
+}
+
+
+
+/*  f is inlined into both, so twz_f() carries no slope work  */
+/*--------------*/
+long double twz_f (long double x, const int64_t *w, const long double *p)
+{
+	return f (x, w, p, NULL);
+}
+
+long double twz_f_slope (long double x, const int64_t *w, const long double *p, long double *slope)
+{
+	return f (x, w, p, slope);
+}
+
+
+
+/*  x is number of days to zero date.  The coarse levels p[i] <= x add
+ *  v(x/p[i])*p[i] and the fine levels v(x*p[i])/p[i], until a fine level
+ *  adds nothing or the powers run out.  Every term is linear on its w[]
+ *  segment, and the p[i] scaling of a term cancels against the chain rule,
+ *  so each one adds just the rise of its segment to the slope.
+ */
+/*--------------*/
+ALWAYS_INLINE long double f (long double x, const int64_t *w, const long double *p, long double *slope)
+{
+	uint64_t i;
+	long double sum = 0.0, last_sum = 0.0;
+
+	if (slope)
+		*slope = 0.0;
+
+	if (x) {
+
+		for (i = 0; x >= p[i]; i++)
+			sum += twz_v (x / p[i], w, slope) * p[i];
+
+		i = 0;
+		do {
+			if (++i > TWZ_CALC_PREC + 2 || i >= TWZ_POWERS)
+				break;
+
+			last_sum = sum;
+			sum += twz_v (x * p[i], w, slope) / p[i];
+
+		} while ((sum == 0.0) || (sum > last_sum));
+
+	}
+
+	/*  dividing by 64^3 gives values consistent with the Apple // version
+	*  and provides more convenient y-axis labels
+	*/
+	if (slope)
+		*slope /= p[3];
+	return sum / p[3];
+}
@@ -0,0 +1,103 @@
+//  twz-kernel.h
+//
+// Based on source code by the original author: Peter Meyer
+//  The timewave itself: the number sets and f(), the sum of their levels
+//  at a point, in the one copy that libtwz.a and every program share.
+//
+//	long double p[TWZ_POWERS], y;
+//
+//	twz_powers (p, 64);
+//	y = twz_f (3650, twz_w[TWZ_WATKINS], p);
+//
+//  Link with libtwz.a -lm.
+
+// Written for the Linux port
+// 19 Oct 2026
+
+/*
+
+This is free and unencumbered software released into the public domain.
+
+Anyone is free to copy, modify, publish, use, compile, sell, or
+distribute this software, either in source code form or as a compiled
+binary, for any purpose, commercial or non-commercial, and by any
+means.
+
+In jurisdictions that recognize copyright laws, the author or authors
+of this software dedicate any and all copyright interest in the
+software to the public domain. We make this dedication for the benefit
+of the public at large and to the detriment of our heirs and
+successors. We intend this dedication to be an overt act of
+relinquishment in perpetuity of all present and future rights to this
+software under copyright law.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+
+For more information, please refer to <http://unlicense.org/>
+
+09 Dec 2012
+*/
+
+#ifndef TWZ_KERNEL_H
+#define TWZ_KERNEL_H
+
+#include <math.h>
+#include <stdint.h>
+
+#define TWZ_SETS 4
+#define TWZ_KELLEY   0
+#define TWZ_WATKINS  1
+#define TWZ_SHELIAK  2
+#define TWZ_HUANG_TI 3
+
+#define TWZ_POWERS 64
+#define TWZ_DATA_POINTS 384
+#define TWZ_CALC_PREC 1000000	//  precision in calculation of wave values
+
+
+//  The number sets, TWZ_DATA_POINTS values each
+extern const int64_t twz_w[TWZ_SETS][TWZ_DATA_POINTS];
+
+
+/*  p[i] = wave_factor^i.  Powers of 64 are exact only up to p[8] in
+ *  double precision, and further in long double.  */
+void twz_powers (long double p[TWZ_POWERS], int64_t wave_factor);
+
+/*  The wave of the number set w (a row of twz_w, or a table of the same
+ *  shape) at x days to zero, p the powers of the wave factor.  Points
+ *  after the zero point (x < 0) read outside w.  */
+long double twz_f (long double x, const int64_t *w, const long double *p);
+
+/*  The same, and its slope per day of dtz into *slope: one-sided, to the
+ *  right of x where x is a breakpoint.  It is the slope of the levels f()
+ *  adds up; the fine loop stops once they no longer change the sum, but
+ *  every finer level would still add as much slope as a coarse one, so
+ *  finite differences of f() only approach it as the step shrinks.  */
+long double twz_f_slope (long double x, const int64_t *w, const long double *p, long double *slope);
+
+/*  One level: w interpolated at y >= 0, wrapping around the table.  The
+ *  rise of the segment under y is added to *slope unless it is NULL.
+ *  Inline, since the programs call it from their own inner loops.
+ *  fmodl/floorl keep the full long double precision: the double versions
+ *  round y once it passes 2^53 and make the fine loop run away.  */
+static inline __attribute__ ((always_inline))
+long double twz_v (long double y, const int64_t *w, long double *slope)
+{
+	int64_t i = (int64_t) (fmodl (y, (long double) TWZ_DATA_POINTS));
+	int64_t j = (i + 1) % TWZ_DATA_POINTS;
+	long double z = y - floorl (y);
+
+	if (slope)
+		*slope += w[j] - w[i];
+
+	return (z == 0.0 ? (long double) w[i] :
+		(w[j] - w[i]) * z + w[i]);
+}
+
+#endif
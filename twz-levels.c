@@ -0,0 +1,141 @@
+//  twz-levels.c
+//
+// Based on source code by the original author: Peter Meyer
+//  The shared coarse level evaluation of twz-levels.h, moved here from
+//  twz-point so twz-point and twz-accuracy run the same code.
+
+// Written for the Linux port
+// 19 Oct 2026
+
+/*
+
+This is free and unencumbered software released into the public domain.
+
+Anyone is free to copy, modify, publish, use, compile, sell, or
+distribute this software, either in source code form or as a compiled
+binary, for any purpose, commercial or non-commercial, and by any
+means.
+
+In jurisdictions that recognize copyright laws, the author or authors
+of this software dedicate any and all copyright interest in the
+software to the public domain. We make this dedication for the benefit
+of the public at large and to the detriment of our heirs and
+successors. We intend this dedication to be an overt act of
+relinquishment in perpetuity of all present and future rights to this
+software under copyright law.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+
+For more information, please refer to <http://unlicense.org/>
+
+09 Dec 2012
+*/
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "twz-levels.h"
+
+
+#define FALSE 0
+#define TRUE  1
+#define NUM_POWERS TWZ_POWERS
+#define NUM_SETS TWZ_SETS
+#define NUM_DATA_POINTS TWZ_DATA_POINTS
+
+
+
+
+
+/*--------------*/
+int twz_levels_start (struct twz_levels *c, int64_t wave_factor)
+{
+	if (wave_factor < 2 || wave_factor > 10000)
+		return FALSE;
+
+	c->wave_factor = wave_factor;
+	c->top = -1;
+	c->sets = (1 << NUM_SETS) - 1;
+	twz_powers (c->powers, wave_factor);
+
+	return TRUE;
+}
+
+
+
+/*  Same as f() for all the number sets at once, taking the coarse levels
+ *  that x shares with the previous point from the cache.  The sum is
+ *  grouped differently from f(), so results can differ from it in the
+ *  last digit.  The slopes (when slope is not NULL) start from the cached
+ *  slope of the coarse levels.
+ */
+/*--------------*/
+void twz_levels_eval (struct twz_levels *c, long double x, long double ans[TWZ_SETS], long double slope[TWZ_SETS])
+{
+	const long double *p = c->powers;
+	int64_t i, set, top, low, n, k, kn;
+	long double y, sum, last_sum;
+
+	if (!x || x < p[0]) {
+		for (set = 0; set < NUM_SETS; set++)
+			if (c->sets & (1 << set))
+				ans[set] = twz_f_slope (x, twz_w[set], p, slope ? &slope[set] : NULL);
+		return;
+	}
+
+	for (top = 0; top + 1 < NUM_POWERS && x >= p[top + 1]; top++)
+		;
+
+	// Lowest level whose cached segment still holds x
+	low = top + 1;
+	if (c->top == top)
+		while (low > 0 && x >= c->base[low - 1] && x < c->base[low - 1] + p[low - 1])
+			low--;
+	c->top = top;
+
+	for (i = low - 1; i >= 0; i--) {
+		y = x / p[i];
+		n = (int64_t) floorl (y);
+		c->base[i] = n * p[i];
+		k = n % NUM_DATA_POINTS;
+		kn = (k + 1) % NUM_DATA_POINTS;
+
+		for (set = 0; set < NUM_SETS; set++) {
+			if (!(c->sets & (1 << set)))
+				continue;
+			c->k[i][set] = twz_w[set][k] * p[i];
+			c->d[i][set] = twz_w[set][kn] - twz_w[set][k];
+			if (i < top) {
+				c->k[i][set] += c->k[i + 1][set] + c->d[i + 1][set] * (c->base[i] - c->base[i + 1]);
+				c->d[i][set] += c->d[i + 1][set];
+			}
+		}
+	}
+
+	for (set = 0; set < NUM_SETS; set++) {
+		if (!(c->sets & (1 << set)))
+			continue;
+		sum = c->k[0][set] + c->d[0][set] * (x - c->base[0]);
+		if (slope)
+			slope[set] = c->d[0][set];
+
+		i = 0;
+		do {
+			if (++i > TWZ_CALC_PREC + 2 || i >= NUM_POWERS)
+				break;
+			last_sum = sum;
+			sum += twz_v (x * p[i], twz_w[set], slope ? &slope[set] : NULL) / p[i];
+		} while ((sum == 0.0) || (sum > last_sum));
+
+		ans[set] = sum / p[3];
+		if (slope)
+			slope[set] /= p[3];
+	}
+}
@@ -0,0 +1,85 @@
+//  twz-levels.h
+//
+// Based on source code by the original author: Peter Meyer
+//  The timewave at points in dtz order, sharing the coarse levels that
+//  neighbouring points have in common: all the sets at once, as twz-point
+//  evaluates its batches.  Sorted (or clustered) points run faster than
+//  with f() on its own; the values can differ from f() in the last digit.
+//
+//	struct twz_levels c;
+//
+//	twz_levels_start (&c, 64);
+//	for (n = 0; n < count; n++)
+//		twz_levels_eval (&c, x[n], ans[n], NULL);
+//
+//  Link with libtwz.a -lm.
+
+// Written for the Linux port
+// 19 Oct 2026
+
+/*
+
+This is free and unencumbered software released into the public domain.
+
+Anyone is free to copy, modify, publish, use, compile, sell, or
+distribute this software, either in source code form or as a compiled
+binary, for any purpose, commercial or non-commercial, and by any
+means.
+
+In jurisdictions that recognize copyright laws, the author or authors
+of this software dedicate any and all copyright interest in the
+software to the public domain. We make this dedication for the benefit
+of the public at large and to the detriment of our heirs and
+successors. We intend this dedication to be an overt act of
+relinquishment in perpetuity of all present and future rights to this
+software under copyright law.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+
+For more information, please refer to <http://unlicense.org/>
+
+09 Dec 2012
+*/
+
+#ifndef TWZ_LEVELS_H
+#define TWZ_LEVELS_H
+
+#include <stdint.h>
+
+#include "twz-stream.h"
+
+
+/*  Coarse levels shared between neighbouring points.
+ *  The segments of level i are [n*powers[i], (n+1)*powers[i]), and each one
+ *  lies inside a segment of level i+1, so the cached segments form a chain:
+ *  a point inside the cached segment of level i shares every level above it.
+ *  k[i] is the sum of the levels >= i at base[i] and d[i] the sum of their
+ *  slopes, so those levels contribute k[i] + d[i]*(x - base[i]) at x.
+ */
+struct twz_levels
+{
+	int64_t wave_factor;
+	int64_t top;				//  highest coarse level of the chain, -1 when empty
+	int64_t sets;				//  bit i set: calculate set i (all after twz_levels_start)
+	long double powers[TWZ_POWERS];
+	long double base[TWZ_POWERS];
+	long double k[TWZ_POWERS][TWZ_SETS];
+	long double d[TWZ_POWERS][TWZ_SETS];
+};
+
+/*  Empty the cache for a new run of points at the given wave factor.
+ *  Returns 0 for an invalid wave factor.  */
+int twz_levels_start (struct twz_levels *c, int64_t wave_factor);
+
+/*  The value of every set in c->sets at x into ans, and its slope (per day
+ *  of dtz) into slope unless it is NULL; the entries of the other sets are
+ *  left alone.  Only points before the zero point (x >= 0) have values.  */
+void twz_levels_eval (struct twz_levels *c, long double x, long double ans[TWZ_SETS], long double slope[TWZ_SETS]);
+
+#endif
@@ -49,15 +49,23 @@ For more information, please refer to <http://unlicense.org/>
 #include <stdint.h>
 #include <string.h>
 #include <ctype.h>
+#include <unistd.h>
+
+#include <pthread.h>
+
+#include "twz-kernel.h"
+#include "twz-bound.h"
+#include "twz-levels.h"
 
 #define FALSE 0
 #define TRUE  1
-#define NUM_POWERS 64
+#define NUM_POWERS TWZ_POWERS
 #define PREC 16 // long double (80 bit) numbers have about 16 significant digits  INTEL / AMD / x86_64
 //#define PREC 32 // long double (128 bit) numbers have about 32 significant digits (QUAD PRECISION)
-#define NUM_SETS 4
-#define NUM_DATA_POINTS 384 
-#define CALC_PREC       1000000  //  precision in calculation of wave values
+#define NUM_SETS TWZ_SETS
+#define MAX_THREADS 256
+#define BATCH_BLOCK 65536	//  query points per block in batch mode
+#define BATCH_STRIDE 256	//  query points a batch thread takes at a time
 
 long double powers[NUM_POWERS];
 //  Powers of (normally) 64.
@@ -69,53 +77,109 @@ int64_t wave_factor = 64;   //  default wave factor
 int64_t number_set, stringchar;
 
 char *usage = "\nUse: twz-point dtz1 dtz2 dtz3 ... [wf=nn]."
-  "\nwf = wave factor (default 64, range 2-10000)\n";
+  "\n  or: twz-point batch=file [wf=nn] [in=bin] [out=bin] [threads=nn]."
+  "\n  or: twz-point bound=a,b ... [wf=nn]."
+  "\n  or: twz-point dtz1 dtz2 ... [wf=nn] tol=t|deadline=us."
+  "\nwf = wave factor (default 64, range 2-10000)"
+  "\nbatch = file of dtz values to evaluate, - for standard input"
+  "\nin=bin = the batch file holds native doubles instead of text"
+  "\nout=bin = write native doubles (dtz, Kelley, Watkins, Sheliak, Huang Ti)"
+  "\n          instead of one text line per point"
+  "\nthreads = number of calculation threads (default: all processors)"
+  "\nshare=off = evaluate every batch point on its own instead of sharing the"
+  "\n            coarse levels between neighbouring points"
+  "\nslope = also print the slope of each set (per day of dtz) of the levels"
+  "\n        f() adds up; it leaves out the finer ones (see README)"
+  "\nbound = guaranteed lower and upper bounds of each set over the dtz"
+  "\n        interval [a, b] (before the zero point), without sampling it"
+  "\ntol = refine each point only until every set is within t of f(), and"
+  "\n      print the bound of its error"
+  "\ndeadline = refine each point for at most us microseconds (with or without"
+  "\n           tol), and print the bound of its error\n";
   
 char temp[32];
 
-char *set_name[NUM_SETS] = { "Kelley", "Watkins", "Sheliak", "Huang Ti" };  
-
-
-//  The number sets.
-int64_t w[NUM_SETS][NUM_DATA_POINTS] = 
+//  Batch mode: three blocks rotate between reading, calculating and writing,
+//  so memory stays bounded however long the input is.
+struct BatchBlock
 {
-	{
-	#include "DATA/DATA.TW1" //  half-twist
-	},
-	{ 
-	#include "DATA/DATA.TW2" //  no half-twist
-	},
-	{ 
-	#include "DATA/DATA.TW3" //  Sheliak 
-	}, 
-	{ 
-	#include "DATA/DATA.TW4" //  HuangTi (no half-twist)
-	} 
+	int64_t count;
+	long double x[BATCH_BLOCK];
+	long double ans[BATCH_BLOCK][NUM_SETS];
+	long double slope[BATCH_BLOCK][NUM_SETS];
 };
 
-void set_powers(void);
-long double f(long double x, int64_t number_set);
-long double v(long double y, int64_t number_set);
-long double mult_power(long double x, int64_t i);
-long double div_power(long double x, int64_t i);
+struct BatchBlock batch_blocks[3];
+struct BatchBlock *batch_current;
+int64_t batch_next;
+int64_t num_threads;
+int64_t binary_in = FALSE, binary_out = FALSE;
+int64_t share_levels = TRUE;
+int64_t want_slope = FALSE;
+int64_t anytime = FALSE;			//  tol= or deadline=: progressive refinement (twz_refine)
+long double refine_tol = 0.0, refine_seconds = 0.0;
+
+char *set_name[NUM_SETS] = { "Kelley", "Watkins", "Sheliak", "Huang Ti" };  
+
+void batch(char *name);
+void *batch_worker(void *arg);
+int64_t read_block(FILE *in, struct BatchBlock *b);
+int compare_points(const void *a, const void *b);
+void write_block(struct BatchBlock *b);
+void print_bound(char *interval);
+void print_refined(long double x);
 
 /*-----------------------------*/
 int main(int argc, char *argv[])
 {
-	long double dtzp;
+	long double dtzp, value, slope;
 	int64_t i, j, ch;
+	char *batch_name = NULL;
 
 	if ( argc == 1 ) {
 		printf("%s",usage);
 		exit(1);
     } 
 
+	num_threads = sysconf(_SC_NPROCESSORS_ONLN);
+
 	for ( i=1; i<argc; i++ ) {
-	    for( stringchar = 0; argv[i][stringchar]; stringchar++) {
+		// Lower-case the option names only: the batch= value is a file name
+	    for( stringchar = 0; argv[i][stringchar] && argv[i][stringchar] != '='; stringchar++) {
 			argv[i][stringchar] = tolower( argv[i][stringchar] );
 		}
+		if ( !argv[i][stringchar] ) {
+		    for( stringchar = 0; argv[i][stringchar]; stringchar++) {
+				argv[i][stringchar] = tolower( argv[i][stringchar] );
+			}
+		}
 		
-		if ( !memcmp(argv[i],"wf=",3) ) {
+		if ( !memcmp(argv[i],"batch=",6) ) {
+			batch_name = &argv[i][6];
+		} else if ( !strcmp(argv[i],"in=bin") ) {
+			binary_in = TRUE;
+		} else if ( !strcmp(argv[i],"out=bin") ) {
+			binary_out = TRUE;
+		} else if ( !strcmp(argv[i],"share=off") ) {
+			share_levels = FALSE;
+		} else if ( !strcmp(argv[i],"slope") ) {
+			want_slope = TRUE;
+		} else if ( !memcmp(argv[i],"tol=",4) ) {
+			refine_tol = atof(&argv[i][4]);
+			anytime = TRUE;
+		} else if ( !memcmp(argv[i],"deadline=",9) ) {
+			refine_seconds = atof(&argv[i][9]) / 1e6;
+			anytime = TRUE;
+		} else if ( !memcmp(argv[i],"bound=",6) ) {
+			// printed in order with the points below
+		} else if ( !memcmp(argv[i],"threads=",8) ) {
+			num_threads = atoi(&argv[i][8]);
+
+			if ( num_threads < 1 || num_threads > MAX_THREADS ) {
+				printf("%s",usage);
+				exit(2);
+			}
+		} else if ( !memcmp(argv[i],"wf=",3) ) {
 	        wave_factor = atoi(&argv[i][3]);
 	        
 			if ( wave_factor < 2 || wave_factor > 10000 ) {
@@ -130,11 +194,25 @@ int main(int argc, char *argv[])
 		}
     }
 
-	set_powers();
+	if ( anytime && ( want_slope || batch_name || refine_tol < 0 || refine_seconds < 0 ) ) {
+		printf("%s",usage);
+		exit(2);
+	}
+
+	twz_powers(powers,wave_factor);
+
+	if ( batch_name ) {
+		batch(batch_name);
+		exit(0);
+	}
+
 	printf("\nWave factor = %ld\n",wave_factor);
 
 	for ( i=1; i<argc; i++ ) {
-	    if ( memcmp(argv[i],"wf=",3) ) {
+	    if ( !memcmp(argv[i],"bound=",6) )
+			print_bound(&argv[i][6]);
+
+	    if ( !strchr(argv[i],'=') && strcmp(argv[i],"slope") ) {
 	        dtzp = atof(argv[i]);
 	        sprintf(temp,"%.*Lf",PREC,dtzp);
 	        j = strlen(temp) - 1;
@@ -152,98 +230,228 @@ int main(int argc, char *argv[])
 			else
 				printf("\nThe value of the timewave %.*Lf days AFTER the zero point is\n",PREC, dtzp * -1); 
 	
+			if ( anytime ) {
+				print_refined(dtzp);
+				continue;
+			}
+
 			for ( number_set=0; number_set<NUM_SETS; number_set++ ) {
-				printf("%.*Lf (%s)\n",PREC,f(dtzp,number_set),set_name[number_set]);
+				if ( want_slope ) {
+					value = twz_f_slope(dtzp,twz_w[number_set],powers,&slope);
+					printf("%.*Lf (%s)  slope %.*Lf per day\n",PREC,value,set_name[number_set],PREC,slope);
+				} else {
+					printf("%.*Lf (%s)\n",PREC,twz_f(dtzp,twz_w[number_set],powers),set_name[number_set]);
+				}
 			}
 		}
     }
 }
 
-//  wave_factor is a global variable
+/*  Bounds of every set over the interval "a,b" (either order), from
+ *  twz_bound in libtwz.a  */
 /*-----------------*/
-void set_powers(void)
+void print_bound(char *interval)
 {
-	uint64_t j;
+	long double a, b, lo[NUM_SETS], hi[NUM_SETS];
+	int64_t n;
 
-	/*  put powers[j] = wave_factor^j  */
+	if ( sscanf(interval,"%Lf,%Lf",&a,&b) != 2 || !twz_bound(fminl(a,b),fmaxl(a,b),wave_factor,lo,hi) ) {
+		printf("\nNo bounds for %s: give two dtz at or before the zero point, as bound=a,b\n",interval);
+		return;
+	}
 
-	powers[0] = (long double)1;
-	
-	for ( j=1; j<NUM_POWERS; j++ )
-		powers[j] = wave_factor*powers[j-1];
+	printf("\nThe timewave from %.*Lf to %.*Lf days BEFORE the zero point lies within\n",PREC,fmaxl(a,b),PREC,fminl(a,b));
+	for ( n=0; n<NUM_SETS; n++ )
+		printf("%.*Lf .. %.*Lf (%s)\n",PREC,lo[n],PREC,hi[n],set_name[n]);
 }
 
-/*  x is number of days to zero date  */
-/*--------------*/
-long double f(long double x, int64_t number_set)
+/*  The value at x refined until tol= or deadline= is met, from twz_refine
+ *  in libtwz.a  */
+/*-----------------*/
+void print_refined(long double x)
 {
-	int i;
-	long double sum = 0.0, last_sum = 0.0;
-
-	if ( x ) {
-		for ( i=0; x>=powers[i]; i++ )
-			sum += mult_power(v(div_power(x,i),number_set),i);
-
-		i = 0;
-		do {
-			if ( ++i > CALC_PREC+2 )
-				break;
-			last_sum = sum;
-			sum += div_power(v(mult_power(x,i),number_set),i);
-	    } while ( ( sum == 0.0 ) || ( sum > last_sum ) );
-    }
+	struct twz_refine r;
+	int64_t n;
 
-	/*  dividing by 64^3 gives values consistent with the Apple // version
-	*  and provides more convenient y-axis labels
-	*/
-	sum = div_power(sum,3);
+	if ( !twz_refine(x,wave_factor,refine_tol,refine_seconds,&r) ) {
+		printf("No estimate: tol= and deadline= work before the zero point only\n");
+		return;
+	}
 
-	return ( sum );
+	for ( n=0; n<NUM_SETS; n++ )
+		printf("%.*Lf +- %.1Le (%s)\n",PREC,r.value[n],r.error[n],set_name[n]);
+	printf("after %ld fine levels%s\n",r.level,r.exact ? ", exact" : "");
 }
 
-/*--------------*/
-long double v(long double y, int64_t number_set)
-{ 
-	int64_t i = (int64_t)(fmod(y,(long double)NUM_DATA_POINTS));
-	int64_t j = (i+1)%NUM_DATA_POINTS;
-	long double z = y - floor(y);
-
-	return ( z==0.0 ? (long double)w[number_set][i] : 
-		( w[number_set][j] - w[number_set][i] )*z + w[number_set][i] );
+/*  Batch mode: stream dtz values from a file (or stdin) and write one
+ *  record per value, in input order.  While the threads calculate one
+ *  block, the main thread writes the previous block and reads the next.
+ */
+/*-----------------------------*/
+void batch(char *name)
+{
+	FILE *in;
+	int64_t t, k, more;
+	pthread_t threads[MAX_THREADS];
+	struct BatchBlock *done = NULL, *next;
+
+	if ( !strcmp(name,"-") )
+		in = stdin;
+	else
+		in = fopen(name, binary_in ? "rb" : "r");
+
+	if ( in == NULL ) {
+		printf("\nError: cannot open %s\n\n",name);
+		exit(4);
+	}
+
+	if ( !binary_out && want_slope )
+		printf("Days to Zero (DTZ), Kelley, slope, Watkins, slope, Sheliak, slope, Huang Ti, slope\n");
+	else if ( !binary_out )
+		printf("Days to Zero (DTZ), Kelley, Watkins, Sheliak, Huang Ti\n");
+
+	k = 0;
+	more = read_block(in,&batch_blocks[k]);
+
+	while ( batch_blocks[k].count > 0 ) {
+		batch_current = &batch_blocks[k];
+		batch_next = 0;
+		
+		for ( t=0; t<num_threads; t++ )
+			pthread_create(&threads[t],NULL,batch_worker,NULL);
+
+		if ( done )
+			write_block(done);
+
+		next = &batch_blocks[(k+1)%3];
+		next->count = 0;
+		if ( more )
+			more = read_block(in,next);
+
+		for ( t=0; t<num_threads; t++ )
+			pthread_join(threads[t],NULL);
+
+		done = batch_current;
+		k = (k+1)%3;
+	}
+
+	if ( done )
+		write_block(done);
+
+	fflush(stdout);
+
+	if ( in != stdin )
+		fclose(in);
 }
 
-/*  in order to speed up the calculation, if wave factor = 64
- *  then instead of using multiplication or division operation
- *  we act directly on the floating point representation;
- *  multiplying by 64^i is accomplished by adding i*0x60
- *  to the exponent (the last 2 bytes of the 8-byte representation);
- *  dividing by 64^i is accomplished by subtracting i*0x60
- *  from the exponent
+/*  Calculation thread: take strides of the current block until none are left.
+ *  Each stride is evaluated in dtz order (sorting it first unless it already
+ *  runs up or down), so neighbouring points share their coarse levels.
  */
+/*--------------*/
+void *batch_worker(void *arg)
+{
+	int64_t first, last, n, set, up, down;
+	struct BatchBlock *b = batch_current;
+	long double *order[BATCH_STRIDE];
+	struct twz_levels *cache = malloc(sizeof(struct twz_levels));
+
+	for ( ;; ) {
+		first = __sync_fetch_and_add(&batch_next,BATCH_STRIDE);
+		if ( first >= b->count )
+			break;
+
+		last = first + BATCH_STRIDE;
+		if ( last > b->count )
+			last = b->count;
+
+		if ( !share_levels || cache == NULL ) {
+			for ( n=first; n<last; n++ )
+				for ( set=0; set<NUM_SETS; set++ )
+					b->ans[n][set] = want_slope ? twz_f_slope(b->x[n],twz_w[set],powers,&b->slope[n][set]) : twz_f(b->x[n],twz_w[set],powers);
+			continue;
+		}
+
+		up = down = TRUE;
+		for ( n=first; n<last; n++ ) {
+			order[n-first] = &b->x[n];
+			if ( n > first && b->x[n] < b->x[n-1] )
+				up = FALSE;
+			if ( n > first && b->x[n] > b->x[n-1] )
+				down = FALSE;
+		}
+		
+		if ( !up && !down )
+			qsort(order,last-first,sizeof(order[0]),compare_points);
+
+		// Neighbouring points share their coarse levels (see twz-levels.h)
+		twz_levels_start(cache,wave_factor);
+		for ( n=0; n<last-first; n++ )
+			twz_levels_eval(cache,*order[n],b->ans[order[n]-b->x],want_slope ? b->slope[order[n]-b->x] : NULL);
+	}
 
-/*-----------------------*/
-long double mult_power(long double x, int64_t i)
+	free(cache);
+	return ( NULL );
+}
+
+/*--------------*/
+int compare_points(const void *a, const void *b)
 {
-/* Removing this code: Swithing to 64-bit datatypes
-int64_t *exponent = (int64_t *)&x + 3;
-if ( wave_factor == 64 )
-    *exponent += i*0x60; //  measurably faster
-else
-*/
-	x *= powers[i];
-	return ( x );
+	long double x = **(long double **)a, y = **(long double **)b;
+
+	return ( ( x > y ) - ( x < y ) );
 }
 
-/*----------------------*/
-long double div_power(long double x, int64_t i)
+/*  Fill a block from the input; returns FALSE once the input is exhausted  */
+/*--------------*/
+int64_t read_block(FILE *in, struct BatchBlock *b)
 {
-	/* Removing trick: moving to 64-bit datatypes
-	int64_t *exponent = (int64_t *)&x + 3;
-	if ( ( wave_factor == 64 ) && ( *exponent > i*0x60 ) )
-	    *exponent -= i*0x60;
-	else
-	*/
-    x /= powers[i];
+	double d;
+	int r;
+
+	b->count = 0;
+	
+	while ( b->count < BATCH_BLOCK ) {
+		if ( binary_in ) {
+			if ( fread(&d,sizeof(d),1,in) != 1 )
+				return ( FALSE );
+			b->x[b->count++] = d;
+		} else {
+			r = fscanf(in,"%Lf",&b->x[b->count]);
+			if ( r == EOF )
+				return ( FALSE );
+			if ( r == 1 )
+				b->count++;
+			else if ( fscanf(in,"%*s") == EOF )	//  skip anything that is not a number
+				return ( FALSE );
+		}
+	}
+
+	return ( TRUE );
+}
 
-	return ( x );
+/*--------------*/
+void write_block(struct BatchBlock *b)
+{
+	int64_t n, r;
+	double rec[2*NUM_SETS+1];
+
+	for ( n=0; n<b->count; n++ ) {
+		if ( binary_out ) {
+			rec[0] = b->x[n];
+			for ( number_set=0, r=1; number_set<NUM_SETS; number_set++ ) {
+				rec[r++] = b->ans[n][number_set];
+				if ( want_slope )
+					rec[r++] = b->slope[n][number_set];
+			}
+			fwrite(rec,sizeof(double),r,stdout);
+		} else if ( want_slope ) {
+			printf("%.*Lf ,%.*Lf ,%.*Lf ,%.*Lf ,%.*Lf ,%.*Lf ,%.*Lf ,%.*Lf ,%.*Lf ,\n",PREC,b->x[n],
+				PREC,b->ans[n][0],PREC,b->slope[n][0],PREC,b->ans[n][1],PREC,b->slope[n][1],
+				PREC,b->ans[n][2],PREC,b->slope[n][2],PREC,b->ans[n][3],PREC,b->slope[n][3]);
+		} else {
+			printf("%.*Lf ,%.*Lf ,%.*Lf ,%.*Lf ,%.*Lf ,\n",PREC,b->x[n],
+				PREC,b->ans[n][0],PREC,b->ans[n][1],PREC,b->ans[n][2],PREC,b->ans[n][3]);
+		}
+	}
 }
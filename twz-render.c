@@ -0,0 +1,396 @@
+//  twz-render.c
+//
+// Based on source code by the original author: Peter Meyer
+//  Draw the timewave within a window straight to an image: the minimum
+//  and maximum of every pixel column are taken from the breakpoints of
+//  the piecewise-linear levels, using multiple threads.
+
+// Written for the Linux port
+// 19 Oct 2026
+
+/*
+
+This is free and unencumbered software released into the public domain.
+
+Anyone is free to copy, modify, publish, use, compile, sell, or
+distribute this software, either in source code form or as a compiled
+binary, for any purpose, commercial or non-commercial, and by any
+means.
+
+In jurisdictions that recognize copyright laws, the author or authors
+of this software dedicate any and all copyright interest in the
+software to the public domain. We make this dedication for the benefit
+of the public at large and to the detriment of our heirs and
+successors. We intend this dedication to be an overt act of
+relinquishment in perpetuity of all present and future rights to this
+software under copyright law.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+
+For more information, please refer to <http://unlicense.org/>
+
+09 Dec 2012
+*/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <pthread.h>
+
+#include "twz-kernel.h"
+
+
+#define FALSE 0
+#define TRUE  1
+#define NUM_POWERS TWZ_POWERS
+#define PREC 16 // long double (80 bit) numbers have about 16 significant digits  INTEL / AMD / x86_64
+//#define PREC 32 // long double (128 bit) numbers have about 32 significant digits (QUAD PRECISION)
+#define NUM_SETS TWZ_SETS
+#define NUM_DATA_POINTS TWZ_DATA_POINTS
+#define MAX_THREADS 256
+#define MAX_BREAKS 64		//  most level breakpoints evaluated per pixel column
+#define MAX_PIXELS 65536	//  largest image width or height
+
+
+long double powers[NUM_POWERS];
+
+//  Powers of (normally) 64.
+//  Due to the limitations of double precision
+//  floating point arithmetic these values are
+//  exact only up to powers[8] for powers of 64.
+
+int64_t wave_factor = 64;		//  default wave factor
+
+
+char *usage = "\nUsage: twz-render [dtz] [neg] [width] [height] [wf] [file] [threads=nn]."
+"\n dtz = days to zero-point"
+"\n neg = days to calculate into negative-time (past zero)"
+"\n width, height = size of the image in pixels"
+"\n wf = wave factor (default 64, range 2-10000)"
+"\n file = output image, a .ppm raster or a .svg drawing"
+"\n threads = number of calculation threads (default: all processors)"
+"\n\nThis program draws the timewave within the given window.  Every pixel column"
+"\nshows the exact minimum and maximum of each number set over the column.\n";
+
+
+char *set_name[NUM_SETS] =
+{ "Kelley", "Watkins", "Sheliak", "Huang Ti" };
+
+//  Colour of each number set in the image
+unsigned char set_color[NUM_SETS][3] =
+{ { 200, 30, 30 }, { 30, 30, 200 }, { 30, 150, 30 }, { 200, 140, 0 } };
+
+
+//  Minimum and maximum of each set over each pixel column
+long double (*col_min)[NUM_SETS], (*col_max)[NUM_SETS];
+long double *col_residual;		//  bound on the levels too fine to resolve per column
+
+int64_t width, height, num_threads;
+int64_t next_column;
+pthread_mutex_t next_lock = PTHREAD_MUTEX_INITIALIZER;
+
+long double dtzp, NegativeBailout, column_width;
+int64_t max_w;
+
+
+void inputerror (void);
+void *worker (void *arg);
+void column (int64_t c);
+void sample (int64_t c, long double x);
+int64_t pixel_row (long double y, long double lo, long double hi);
+void write_ppm (FILE *out, long double lo, long double hi);
+void write_svg (FILE *out, long double lo, long double hi);
+
+long double div_power (long double x, int64_t i);
+
+
+/*-----------------------------*/
+int main (int argc, char *argv[])
+{
+	int64_t i, c, t, number_set;
+	long double lo = INFINITY, hi = -INFINITY, residual = 0.0;
+	pthread_t threads[MAX_THREADS];
+	FILE *out;
+	char *ext;
+
+	if (argc < 7) {
+		printf ("%s", usage);
+		inputerror ();
+	}
+
+	num_threads = sysconf (_SC_NPROCESSORS_ONLN);
+
+	for (i = 7; i < argc; i++) {
+		if (!memcmp (argv[i], "threads=", 8))
+			num_threads = atoi (&argv[i][8]);
+		else {
+			printf ("%s", usage);
+			inputerror ();
+		}
+	}
+
+	if (num_threads < 1)
+		num_threads = 1;
+	if (num_threads > MAX_THREADS)
+		num_threads = MAX_THREADS;
+
+	dtzp = atof (&argv[1][0]);
+
+	NegativeBailout = atof (&argv[2][0]);
+	NegativeBailout *= -1;
+
+	width = atoi (&argv[3][0]);
+	height = atoi (&argv[4][0]);
+
+	wave_factor = atoi (&argv[5][0]);
+
+	ext = strrchr (argv[6], '.');
+
+	if (wave_factor < 2 || wave_factor > 10000 || dtzp <= NegativeBailout
+		|| width < 1 || width > MAX_PIXELS || height < 2 || height > MAX_PIXELS
+		|| ext == NULL || (strcmp (ext, ".ppm") && strcmp (ext, ".svg"))) {
+		printf ("%s", usage);
+		inputerror ();
+	}
+
+	twz_powers (powers, wave_factor);
+
+	for (number_set = 0; number_set < NUM_SETS; number_set++)
+		for (i = 0; i < NUM_DATA_POINTS; i++)
+			if (twz_w[number_set][i] > max_w)
+				max_w = twz_w[number_set][i];
+
+	column_width = (dtzp - NegativeBailout) / width;
+
+	col_min = malloc (width * sizeof (*col_min));
+	col_max = malloc (width * sizeof (*col_max));
+	col_residual = malloc (width * sizeof (long double));
+	if (col_min == NULL || col_max == NULL || col_residual == NULL)
+		inputerror ();
+
+	next_column = 0;
+	for (t = 0; t < num_threads; t++)
+		pthread_create (&threads[t], NULL, worker, NULL);
+	for (t = 0; t < num_threads; t++)
+		pthread_join (threads[t], NULL);
+
+	// One vertical scale for all the sets, as in a spreadsheet chart
+	for (c = 0; c < width; c++) {
+		for (number_set = 0; number_set < NUM_SETS; number_set++) {
+			if (col_min[c][number_set] < lo)
+				lo = col_min[c][number_set];
+			if (col_max[c][number_set] > hi)
+				hi = col_max[c][number_set];
+		}
+		if (col_residual[c] > residual)
+			residual = col_residual[c];
+	}
+
+	if (hi <= lo)
+		hi = lo + 1.0;
+
+	out = fopen (argv[6], "wb");
+	if (out == NULL)
+		inputerror ();
+
+	if (!strcmp (ext, ".ppm"))
+		write_ppm (out, lo, hi);
+	else
+		write_svg (out, lo, hi);
+
+	fclose (out);
+
+	fprintf (stderr, "Values from %.*Lf to %.*Lf; levels finer than a column "
+		"add at most %.*Lf (%.3Lf pixels)\n", PREC, lo, PREC, hi, PREC, residual,
+		residual * (height - 1) / (hi - lo));
+
+	return 0;
+}
+
+
+
+//  Calculation thread: take pixel columns until none are left
+/*--------------*/
+void *worker (void *arg)
+{
+	int64_t c;
+
+	for (;;) {
+		pthread_mutex_lock (&next_lock);
+		c = next_column++;
+		pthread_mutex_unlock (&next_lock);
+
+		if (c >= width)
+			break;
+
+		column (c);
+	}
+
+	return NULL;
+}
+
+
+
+/*  Every level of f() is linear between multiples of its spacing, powers[i]
+ *  for the coarse levels and 1/powers[i] for the fine ones.  The spacings
+ *  are powers of the wave factor, so the breakpoints of all the levels at
+ *  least h apart are the multiples of h.  Evaluating f() at those multiples
+ *  and at the ends of the column gives the exact minimum and maximum of the
+ *  wave with the finer levels left out; those add at most
+ *  max_w * (h/wf + h/wf^2 + ...) before the final division by wf^3.
+ */
+/*--------------*/
+void column (int64_t c)
+{
+	int64_t i, number_set;
+	long double a, b, h, m;
+
+	b = dtzp - c * column_width;
+	a = (c == width - 1) ? NegativeBailout : b - column_width;
+
+	// Finest power of the wave factor that leaves at most MAX_BREAKS breakpoints
+	h = powers[0];
+	for (i = 1; i < NUM_POWERS && (b - a) / h > MAX_BREAKS; i++)
+		h = powers[i];
+	for (i = 1; i < NUM_POWERS && (b - a) / (h / wave_factor) <= MAX_BREAKS; i++)
+		h /= wave_factor;
+
+	for (number_set = 0; number_set < NUM_SETS; number_set++) {
+		col_min[c][number_set] = INFINITY;
+		col_max[c][number_set] = -INFINITY;
+	}
+
+	sample (c, a);
+	for (m = floorl (a / h) + 1, i = 0; m * h < b && i < MAX_BREAKS; m++, i++)
+		if (m * h > a)
+			sample (c, m * h);
+	sample (c, b);
+
+	col_residual[c] = div_power (max_w * h / (wave_factor - 1), 3);
+}
+
+
+
+/*--------------*/
+void sample (int64_t c, long double x)
+{
+	int64_t number_set;
+	long double y;
+
+	for (number_set = 0; number_set < NUM_SETS; number_set++) {
+		y = twz_f (x, twz_w[number_set], powers);
+		if (y < col_min[c][number_set])
+			col_min[c][number_set] = y;
+		if (y > col_max[c][number_set])
+			col_max[c][number_set] = y;
+	}
+}
+
+
+
+//  Row of the image for value y; row 0 is the top
+/*--------------*/
+int64_t pixel_row (long double y, long double lo, long double hi)
+{
+	int64_t r = (int64_t) lrintl ((hi - y) / (hi - lo) * (height - 1));
+
+	if (r < 0)
+		r = 0;
+	if (r > height - 1)
+		r = height - 1;
+	return r;
+}
+
+
+
+//  Binary PPM raster: each set is a vertical bar from its column minimum
+//  to its column maximum, drawn in the set's colour on white
+/*--------------*/
+void write_ppm (FILE *out, long double lo, long double hi)
+{
+	int64_t c, r, top, bottom, number_set;
+	unsigned char *image = malloc (width * height * 3);
+
+	if (image == NULL)
+		inputerror ();
+
+	memset (image, 255, width * height * 3);
+
+	for (c = 0; c < width; c++) {
+		for (number_set = NUM_SETS - 1; number_set >= 0; number_set--) {
+			top = pixel_row (col_max[c][number_set], lo, hi);
+			bottom = pixel_row (col_min[c][number_set], lo, hi);
+			for (r = top; r <= bottom; r++)
+				memcpy (&image[(r * width + c) * 3], set_color[number_set], 3);
+		}
+	}
+
+	fprintf (out, "P6\n# timewave from %.*Lf to %.*Lf days to zero, wave factor %ld\n"
+		"# values from %.*Lf (bottom) to %.*Lf (top)\n%ld %ld\n255\n",
+		PREC, dtzp, PREC, NegativeBailout, wave_factor, PREC, lo, PREC, hi, width, height);
+	fwrite (image, 3, width * height, out);
+	free (image);
+}
+
+
+
+//  SVG drawing: one polyline per set running down and up every column
+//  between the column minimum and maximum
+/*--------------*/
+void write_svg (FILE *out, long double lo, long double hi)
+{
+	int64_t c, number_set;
+
+	fprintf (out, "<?xml version=\"1.0\"?>\n"
+		"<!-- timewave from %.*Lf to %.*Lf days to zero, wave factor %ld -->\n"
+		"<!-- values from %.*Lf (bottom) to %.*Lf (top) -->\n"
+		"<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"%ld\" height=\"%ld\">\n"
+		"<rect width=\"100%%\" height=\"100%%\" fill=\"white\"/>\n",
+		PREC, dtzp, PREC, NegativeBailout, wave_factor, PREC, lo, PREC, hi, width, height);
+
+	for (number_set = 0; number_set < NUM_SETS; number_set++) {
+		fprintf (out, "<polyline fill=\"none\" stroke-width=\"1\" stroke=\"rgb(%d,%d,%d)\" points=\"",
+			set_color[number_set][0], set_color[number_set][1], set_color[number_set][2]);
+
+		// Alternate the direction of travel so consecutive columns join up
+		for (c = 0; c < width; c++) {
+			if (c % 2)
+				fprintf (out, "%ld.5,%ld %ld.5,%ld ", c, pixel_row (col_min[c][number_set], lo, hi),
+					c, pixel_row (col_max[c][number_set], lo, hi));
+			else
+				fprintf (out, "%ld.5,%ld %ld.5,%ld ", c, pixel_row (col_max[c][number_set], lo, hi),
+					c, pixel_row (col_min[c][number_set], lo, hi));
+		}
+
+		fprintf (out, "\"><title>%s</title></polyline>\n", set_name[number_set]);
+	}
+
+	fprintf (out, "</svg>\n");
+}
+
+
+
+/*----------------------*/
+long double div_power (long double x, int64_t i)
+{
+	x /= powers[i];
+	return (x);
+}
+
+
+
+void inputerror (void)
+{
+	printf ("\nError: Invalid input, exiting.\n\n");
+	exit (EXIT_SUCCESS);
+}
@@ -0,0 +1,454 @@
+//  twz-resonance.c
+//
+// Based on source code by the original author: Peter Meyer
+//  Search a range of the timewave for the windows whose shape resonates
+//  with a reference window, at scales of wave_factor^k, by normalized
+//  cross-correlation computed with FFTs, using multiple threads.
+
+// Written for the Linux port
+// 19 Oct 2026
+
+/*
+
+This is free and unencumbered software released into the public domain.
+
+Anyone is free to copy, modify, publish, use, compile, sell, or
+distribute this software, either in source code form or as a compiled
+binary, for any purpose, commercial or non-commercial, and by any
+means.
+
+In jurisdictions that recognize copyright laws, the author or authors
+of this software dedicate any and all copyright interest in the
+software to the public domain. We make this dedication for the benefit
+of the public at large and to the detriment of our heirs and
+successors. We intend this dedication to be an overt act of
+relinquishment in perpetuity of all present and future rights to this
+software under copyright law.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+
+For more information, please refer to <http://unlicense.org/>
+
+09 Dec 2012
+*/
+
+#include <math.h>
+#include <complex.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <pthread.h>
+
+#include "twz-kernel.h"
+
+
+#define FALSE 0
+#define TRUE  1
+#define NUM_POWERS TWZ_POWERS
+#define PREC 16 // long double (80 bit) numbers have about 16 significant digits  INTEL / AMD / x86_64
+//#define PREC 32 // long double (128 bit) numbers have about 32 significant digits (QUAD PRECISION)
+#define NUM_SETS TWZ_SETS
+#define MAX_THREADS 256
+#define MAX_TOP 1000
+#define MIN_BLOCK 4096		//  smallest FFT block
+
+
+long double powers[NUM_POWERS];
+
+//  Powers of (normally) 64.
+//  Due to the limitations of double precision
+//  floating point arithmetic these values are
+//  exact only up to powers[8] for powers of 64.
+
+int64_t wave_factor = 64;		//  default wave factor
+
+
+char *usage = "\nUsage: twz-resonance [ref] [ref_end] [from] [to] [samples] [wf] [scales=a:b] [top=nn] [threads=nn]."
+"\n ref, ref_end = reference window, in days to zero-point"
+"\n from, to = range to search, in days to zero-point"
+"\n samples = number of samples taken across the reference window"
+"\n wf = wave factor (default 64, range 2-10000)"
+"\n scales = powers k of the wave factor by which a match may be longer than the"
+"\n          reference (default 0:0, negative k for shorter matches)"
+"\n top = number of matches to print per number set (default 10)"
+"\n threads = number of calculation threads (default: all processors)"
+"\n\nThis program finds the windows within the search range whose timewave has the"
+"\nhighest normalized cross-correlation with the reference window.\n";
+
+
+char *set_name[NUM_SETS] =
+{ "Kelley", "Watkins", "Sheliak", "Huang Ti" };
+
+
+char *title = "Set, Scale (k), Start (DTZ), End (DTZ), Correlation";
+
+
+//  A window of the search range and its correlation with the reference
+struct Match
+{
+	int64_t scale;
+	long double start, end;
+	double score;
+};
+
+//  Best matches so far, one list per set and thread, best first
+struct TopList
+{
+	int64_t count;
+	struct Match m[MAX_TOP];
+};
+
+//  The search is split into tasks, one per FFT block of one scale;
+//  the tasks of scale k are numbered from first_task[k - scale_lo]
+struct Task
+{
+	int64_t scale;
+	int64_t first;		//  index of the first window of the block
+	int64_t windows;	//  number of windows of the scale
+};
+
+int64_t samples, block_size, windows_per_block, scale_lo = 0, scale_hi = 0, top = 10;
+int64_t num_threads, next_task, num_tasks;
+int64_t first_task[2 * NUM_POWERS + 1], scale_windows[2 * NUM_POWERS];
+pthread_mutex_t next_lock = PTHREAD_MUTEX_INITIALIZER;
+
+long double ref_start, ref_end, search_start, search_end, ref_step;
+
+//  Spectrum of the reference of each set, zero-mean and scaled by 1/(samples * std dev)
+double complex *ref_spectrum[NUM_SETS];
+
+struct TopList (*thread_top)[NUM_SETS];
+
+
+void inputerror (void);
+void *worker (void *arg);
+void fft (double complex *a, int64_t n, int inverse);
+void insert (struct TopList *t, struct Match *m);
+long double scale_step (int64_t k);
+
+long double mult_power (long double x, int64_t i);
+long double div_power (long double x, int64_t i);
+
+
+/*-----------------------------*/
+int main (int argc, char *argv[])
+{
+	int64_t i, k, t, number_set, windows;
+	long double y, sum, sum2, mean, stddev;
+	double complex *buf;
+	pthread_t threads[MAX_THREADS];
+	struct TopList all;
+	char *colon;
+
+	if (argc < 7) {
+		printf ("%s", usage);
+		inputerror ();
+	}
+
+	num_threads = sysconf (_SC_NPROCESSORS_ONLN);
+
+	for (i = 7; i < argc; i++) {
+		if (!memcmp (argv[i], "scales=", 7)) {
+			scale_lo = scale_hi = atoi (&argv[i][7]);
+			colon = strchr (argv[i], ':');
+			if (colon)
+				scale_hi = atoi (colon + 1);
+		} else if (!memcmp (argv[i], "top=", 4))
+			top = atoi (&argv[i][4]);
+		else if (!memcmp (argv[i], "threads=", 8))
+			num_threads = atoi (&argv[i][8]);
+		else {
+			printf ("%s", usage);
+			inputerror ();
+		}
+	}
+
+	if (num_threads < 1)
+		num_threads = 1;
+	if (num_threads > MAX_THREADS)
+		num_threads = MAX_THREADS;
+
+	ref_start = atof (&argv[1][0]);
+	ref_end = atof (&argv[2][0]);
+	search_start = atof (&argv[3][0]);
+	search_end = atof (&argv[4][0]);
+	samples = atoll (&argv[5][0]);
+	wave_factor = atoi (&argv[6][0]);
+
+	if (wave_factor < 2 || wave_factor > 10000 || samples < 2 || ref_start <= ref_end
+		|| search_start <= search_end || top < 1 || top > MAX_TOP || scale_lo > scale_hi
+		|| scale_lo <= -NUM_POWERS || scale_hi >= NUM_POWERS) {
+		printf ("%s", usage);
+		inputerror ();
+	}
+
+	twz_powers (powers, wave_factor);
+
+	ref_step = (ref_start - ref_end) / (samples - 1);
+
+	// FFT blocks of at least four reference lengths keep the overlap small
+	for (block_size = MIN_BLOCK; block_size < 4 * samples; block_size *= 2)
+		;
+	windows_per_block = block_size - samples + 1;
+
+	// Reference spectra
+	for (number_set = 0; number_set < NUM_SETS; number_set++) {
+		buf = calloc (block_size, sizeof (double complex));
+		ref_spectrum[number_set] = buf;
+		if (buf == NULL)
+			inputerror ();
+
+		sum = sum2 = 0.0;
+		for (i = 0; i < samples; i++) {
+			y = twz_f (ref_start - i * ref_step, twz_w[number_set], powers);
+			buf[i] = y;
+			sum += y;
+			sum2 += y * y;
+		}
+
+		mean = sum / samples;
+		stddev = sqrtl (fmaxl (sum2 / samples - mean * mean, 0.0));
+		if (stddev == 0.0) {
+			fprintf (stderr, "The %s reference window is flat\n", set_name[number_set]);
+			stddev = 1.0;
+		}
+
+		for (i = 0; i < samples; i++)
+			buf[i] = (creal (buf[i]) - mean) / (samples * stddev);
+
+		fft (buf, block_size, FALSE);
+	}
+
+	// One task per FFT block of every scale
+	num_tasks = 0;
+	for (k = scale_lo; k <= scale_hi; k++) {
+		windows = (int64_t) ((search_start - search_end) / scale_step (k)) + 1 - samples + 1;
+		if (windows < 1) {
+			fprintf (stderr, "The search range is shorter than a match at scale %ld\n", k);
+			windows = 0;
+		}
+
+		scale_windows[k - scale_lo] = windows;
+		first_task[k - scale_lo] = num_tasks;
+		num_tasks += (windows + windows_per_block - 1) / windows_per_block;
+	}
+	first_task[scale_hi - scale_lo + 1] = num_tasks;
+
+	thread_top = calloc (num_threads, sizeof (*thread_top));
+	if (thread_top == NULL)
+		inputerror ();
+
+	next_task = 0;
+	for (t = 0; t < num_threads; t++)
+		pthread_create (&threads[t], NULL, worker, thread_top[t]);
+	for (t = 0; t < num_threads; t++)
+		pthread_join (threads[t], NULL);
+
+	printf ("\n%s\n", title);
+
+	for (number_set = 0; number_set < NUM_SETS; number_set++) {
+		all.count = 0;
+		for (t = 0; t < num_threads; t++)
+			for (i = 0; i < thread_top[t][number_set].count; i++)
+				insert (&all, &thread_top[t][number_set].m[i]);
+
+		for (i = 0; i < all.count; i++)
+			printf ("%s ,%ld ,%.*Lf ,%.*Lf ,%.*f ,\n", set_name[number_set], all.m[i].scale,
+				PREC, all.m[i].start, PREC, all.m[i].end, PREC, all.m[i].score);
+	}
+
+	return 0;
+}
+
+
+
+//  Sample step of the matches at scale k: the reference step times wf^k
+/*--------------*/
+long double scale_step (int64_t k)
+{
+	return k >= 0 ? mult_power (ref_step, k) : div_power (ref_step, -k);
+}
+
+
+
+/*  Calculation thread: evaluate the wave over one block of the search
+ *  range (block_size samples, all sets at once), correlate it with the
+ *  references through the FFT and keep the local maxima of the
+ *  correlation.  The blocks of a scale overlap by samples - 1.
+ */
+/*--------------*/
+void *worker (void *arg)
+{
+	struct TopList *mine = (struct TopList *) arg;
+	struct Task task_buf, *task = &task_buf;
+	struct Match m;
+	int64_t i, j, n, number_set;
+	long double step, y;
+	long double *values = malloc (block_size * NUM_SETS * sizeof (long double));
+	long double *sum = malloc ((block_size + 1) * sizeof (long double));
+	long double *sum2 = malloc ((block_size + 1) * sizeof (long double));
+	double *score = malloc (block_size * sizeof (double));
+	double complex *buf = malloc (block_size * sizeof (double complex));
+	long double mean, var;
+
+	if (values == NULL || sum == NULL || sum2 == NULL || score == NULL || buf == NULL)
+		inputerror ();
+
+	for (;;) {
+		pthread_mutex_lock (&next_lock);
+		i = next_task++;
+		pthread_mutex_unlock (&next_lock);
+
+		if (i >= num_tasks)
+			break;
+
+		for (task->scale = scale_lo; first_task[task->scale - scale_lo + 1] <= i; task->scale++)
+			;
+		task->windows = scale_windows[task->scale - scale_lo];
+		task->first = (i - first_task[task->scale - scale_lo]) * windows_per_block;
+		step = scale_step (task->scale);
+
+		// Samples of the block; past the last window they are not needed
+		n = task->windows - task->first;
+		if (n > windows_per_block)
+			n = windows_per_block;
+		n += samples - 1;
+
+		for (j = 0; j < n; j++)
+			for (number_set = 0; number_set < NUM_SETS; number_set++)
+				values[j * NUM_SETS + number_set] = twz_f (search_start - (task->first + j) * step, twz_w[number_set], powers);
+
+		for (number_set = 0; number_set < NUM_SETS; number_set++) {
+			sum[0] = sum2[0] = 0.0;
+			for (j = 0; j < block_size; j++) {
+				y = j < n ? values[j * NUM_SETS + number_set] : 0.0;
+				buf[j] = y;
+				sum[j + 1] = sum[j] + y;
+				sum2[j + 1] = sum2[j] + y * y;
+			}
+
+			// Cross-correlation with the reference: IFFT (C * conj (R))
+			fft (buf, block_size, FALSE);
+			for (j = 0; j < block_size; j++)
+				buf[j] *= conj (ref_spectrum[number_set][j]);
+			fft (buf, block_size, TRUE);
+
+			for (j = 0; j + samples <= n; j++) {
+				mean = (sum[j + samples] - sum[j]) / samples;
+				var = (sum2[j + samples] - sum2[j]) / samples - mean * mean;
+				score[j] = var > 0.0 ? creal (buf[j]) / sqrtl (var) : 0.0;
+			}
+
+			for (j = 0; j + samples <= n; j++) {
+				if ((j > 0 && score[j - 1] > score[j]) || (j + samples < n && score[j + 1] >= score[j]))
+					continue;		//  only the local maxima of the correlation
+
+				m.scale = task->scale;
+				m.start = search_start - (task->first + j) * step;
+				m.end = m.start - (samples - 1) * step;
+				m.score = score[j];
+				insert (&mine[number_set], &m);
+			}
+		}
+	}
+
+	free (values);
+	free (sum);
+	free (sum2);
+	free (score);
+	free (buf);
+	return NULL;
+}
+
+
+
+//  Keep the best matches, best first
+/*--------------*/
+void insert (struct TopList *t, struct Match *m)
+{
+	int64_t i;
+
+	if (t->count == top && m->score <= t->m[top - 1].score)
+		return;
+
+	if (t->count < top)
+		t->count++;
+
+	for (i = t->count - 1; i > 0 && t->m[i - 1].score < m->score; i--)
+		t->m[i] = t->m[i - 1];
+	t->m[i] = *m;
+}
+
+
+
+/*  In-place iterative radix-2 FFT; n is a power of two.
+ *  The inverse transform is scaled by 1/n.
+ */
+/*--------------*/
+void fft (double complex *a, int64_t n, int inverse)
+{
+	int64_t i, j, len, half, k;
+	double complex t, u, step, rot;
+
+	for (i = 1, j = 0; i < n; i++) {
+		for (k = n >> 1; j & k; k >>= 1)
+			j ^= k;
+		j |= k;
+		if (i < j) {
+			t = a[i];
+			a[i] = a[j];
+			a[j] = t;
+		}
+	}
+
+	for (len = 2; len <= n; len <<= 1) {
+		half = len >> 1;
+		step = cexp ((inverse ? 2 : -2) * M_PI * I / len);
+		for (i = 0; i < n; i += len) {
+			rot = 1.0;
+			for (k = 0; k < half; k++) {
+				u = a[i + k];
+				t = a[i + k + half] * rot;
+				a[i + k] = u + t;
+				a[i + k + half] = u - t;
+				rot *= step;
+			}
+		}
+	}
+
+	if (inverse)
+		for (i = 0; i < n; i++)
+			a[i] /= n;
+}
+/*-----------------------*/
+long double mult_power (long double x, int64_t i)
+{
+	x *= powers[i];
+	return (x);
+}
+
+
+
+/*----------------------*/
+long double div_power (long double x, int64_t i)
+{
+	x /= powers[i];
+	return (x);
+}
+
+
+
+void inputerror (void)
+{
+	printf ("\nError: Invalid input, exiting.\n\n");
+	exit (EXIT_SUCCESS);
+}
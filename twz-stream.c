@@ -0,0 +1,311 @@
+//  twz-stream.c
+//
+// Based on source code by the original author: Peter Meyer
+//  The pull API of twz-stream.h: batches of a timewave window computed
+//  ahead by a pool of threads into a bounded ring.
+
+// Written for the Linux port
+// 19 Oct 2026
+
+/*
+
+This is free and unencumbered software released into the public domain.
+
+Anyone is free to copy, modify, publish, use, compile, sell, or
+distribute this software, either in source code form or as a compiled
+binary, for any purpose, commercial or non-commercial, and by any
+means.
+
+In jurisdictions that recognize copyright laws, the author or authors
+of this software dedicate any and all copyright interest in the
+software to the public domain. We make this dedication for the benefit
+of the public at large and to the detriment of our heirs and
+successors. We intend this dedication to be an overt act of
+relinquishment in perpetuity of all present and future rights to this
+software under copyright law.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+
+For more information, please refer to <http://unlicense.org/>
+
+09 Dec 2012
+*/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <pthread.h>
+
+#include "twz-stream.h"
+
+
+#define FALSE 0
+#define TRUE  1
+#define NUM_SETS TWZ_SETS
+#define MAX_THREADS 256
+#define DEFAULT_BATCH 4096
+
+
+/*  Batches b, b + depth, b + 2*depth, ... take turns in slot b % depth.
+ *  A worker only starts batch b once batch b - depth has been released by
+ *  the consumer, which keeps the ring bounded.
+ */
+struct Slot
+{
+	int64_t index;				//  batch ready in the slot, -1 while it is computed
+	long double *dtz;
+	long double (*values)[NUM_SETS];
+};
+
+struct twz_stream
+{
+	struct twz_stream_options o;
+	long double step;			//  days
+	long double powers[TWZ_POWERS];
+	int64_t samples, num_batches;
+	int64_t next_batch;			//  next batch for a worker
+	int64_t consumed;			//  batches released by the consumer
+	int64_t holding;			//  the consumer holds batch consumed
+	int64_t cancel;
+	int64_t num_threads;
+	pthread_t thread[MAX_THREADS];
+	struct Slot *slots;
+	pthread_mutex_t lock;
+	pthread_cond_t slot_free;
+	pthread_cond_t batch_done;
+};
+
+
+
+
+static void *worker (void *arg);
+static void free_stream (struct twz_stream *s);
+
+
+
+/*--------------*/
+void twz_stream_defaults (struct twz_stream_options *o)
+{
+	memset (o, 0, sizeof (*o));
+	o->dtz = 10;
+	o->neg = 0;
+	o->step = 60;
+	o->wave_factor = 64;
+}
+
+
+
+/*--------------*/
+struct twz_stream *twz_stream_open (const struct twz_stream_options *o)
+{
+	struct twz_stream *s;
+	int64_t i, cpus;
+
+	// Past the zero point f() would index the data points below 0, as in twz_bound
+	if (o->step <= 0 || o->neg > 0 || o->wave_factor < 2 || o->wave_factor > 10000 || o->sets < 0 || o->sets >= 1 << NUM_SETS
+		|| o->threads < 0 || o->batch < 0 || o->depth < 0)
+		return NULL;
+
+	s = calloc (1, sizeof (struct twz_stream));
+	if (s == NULL)
+		return NULL;
+
+	s->o = *o;
+	if (s->o.sets == 0)
+		s->o.sets = (1 << NUM_SETS) - 1;
+	if (s->o.threads == 0) {
+		cpus = sysconf (_SC_NPROCESSORS_ONLN);
+		s->o.threads = cpus < 1 ? 1 : cpus;
+	}
+	if (s->o.threads > MAX_THREADS)
+		s->o.threads = MAX_THREADS;
+	if (s->o.batch == 0)
+		s->o.batch = DEFAULT_BATCH;
+	if (s->o.depth == 0)
+		s->o.depth = 2 * s->o.threads;
+
+	s->step = o->step / 60 / 24;
+	s->samples = o->dtz < -o->neg ? 0 : (int64_t) floorl ((o->dtz + o->neg) / s->step + 1e-9L) + 1;
+	s->num_batches = (s->samples + s->o.batch - 1) / s->o.batch;
+
+	twz_powers (s->powers, s->o.wave_factor);
+
+	pthread_mutex_init (&s->lock, NULL);
+	pthread_cond_init (&s->slot_free, NULL);
+	pthread_cond_init (&s->batch_done, NULL);
+
+	s->slots = calloc (s->o.depth, sizeof (struct Slot));
+	for (i = 0; s->slots && i < s->o.depth; i++) {
+		s->slots[i].index = -1;
+		s->slots[i].dtz = malloc (s->o.batch * sizeof (long double));
+		s->slots[i].values = calloc (s->o.batch, sizeof (*s->slots[i].values));
+		if (s->slots[i].dtz == NULL || s->slots[i].values == NULL) {
+			free_stream (s);
+			return NULL;
+		}
+	}
+	if (s->slots == NULL) {
+		free_stream (s);
+		return NULL;
+	}
+
+	for (i = 0; i < s->o.threads; i++) {
+		if (pthread_create (&s->thread[i], NULL, worker, s))
+			break;
+		s->num_threads++;
+	}
+	if (s->num_threads == 0) {
+		free_stream (s);
+		return NULL;
+	}
+
+	return s;
+}
+
+
+
+/*--------------*/
+int64_t twz_stream_next (struct twz_stream *s, struct twz_batch *b)
+{
+	struct Slot *slot;
+	int64_t c;
+
+	pthread_mutex_lock (&s->lock);
+
+	if (s->holding) {
+		s->slots[s->consumed % s->o.depth].index = -1;
+		s->consumed++;
+		s->holding = FALSE;
+		pthread_cond_broadcast (&s->slot_free);
+	}
+
+	c = s->consumed;
+	if (c >= s->num_batches) {
+		pthread_mutex_unlock (&s->lock);
+		b->first = s->samples;
+		b->count = 0;
+		b->dtz = NULL;
+		b->values = NULL;
+		return 0;
+	}
+
+	slot = &s->slots[c % s->o.depth];
+	while (slot->index != c)
+		pthread_cond_wait (&s->batch_done, &s->lock);
+	s->holding = TRUE;
+
+	pthread_mutex_unlock (&s->lock);
+
+	b->first = c * s->o.batch;
+	b->count = b->first + s->o.batch < s->samples ? s->o.batch : s->samples - b->first;
+	b->dtz = slot->dtz;
+	b->values = (const long double (*)[NUM_SETS]) slot->values;
+
+	return b->count;
+}
+
+
+
+/*--------------*/
+int64_t twz_stream_samples (struct twz_stream *s)
+{
+	return s->samples;
+}
+
+
+
+/*--------------*/
+void twz_stream_close (struct twz_stream *s)
+{
+	int64_t i;
+
+	if (s == NULL)
+		return;
+
+	pthread_mutex_lock (&s->lock);
+	__atomic_store_n (&s->cancel, TRUE, __ATOMIC_RELAXED);
+	pthread_cond_broadcast (&s->slot_free);
+	pthread_mutex_unlock (&s->lock);
+
+	for (i = 0; i < s->num_threads; i++)
+		pthread_join (s->thread[i], NULL);
+
+	free_stream (s);
+}
+
+
+
+/*--------------*/
+static void free_stream (struct twz_stream *s)
+{
+	int64_t i;
+
+	for (i = 0; s->slots && i < s->o.depth; i++) {
+		free (s->slots[i].dtz);
+		free (s->slots[i].values);
+	}
+	free (s->slots);
+	pthread_mutex_destroy (&s->lock);
+	pthread_cond_destroy (&s->slot_free);
+	pthread_cond_destroy (&s->batch_done);
+	free (s);
+}
+
+
+
+/*  Take the next batch once its slot is free, compute it, repeat.  The
+ *  cancel flag is checked at every sample, so closing the stream does not
+ *  wait for whole batches nobody will read.
+ */
+/*--------------*/
+static void *worker (void *arg)
+{
+	struct twz_stream *s = arg;
+	struct Slot *slot;
+	int64_t b, n, first, last, set;
+	long double x;
+
+	for (;;) {
+		pthread_mutex_lock (&s->lock);
+		while (!s->cancel && s->next_batch < s->num_batches && s->next_batch >= s->consumed + s->o.depth)
+			pthread_cond_wait (&s->slot_free, &s->lock);
+		if (s->cancel || s->next_batch >= s->num_batches) {
+			pthread_mutex_unlock (&s->lock);
+			break;
+		}
+		b = s->next_batch++;
+		pthread_mutex_unlock (&s->lock);
+
+		slot = &s->slots[b % s->o.depth];
+		first = b * s->o.batch;
+		last = first + s->o.batch < s->samples ? first + s->o.batch : s->samples;
+
+		for (n = first; n < last && !__atomic_load_n (&s->cancel, __ATOMIC_RELAXED); n++) {
+			x = s->o.dtz - n * s->step;
+			slot->dtz[n - first] = x;
+			// The last sample can round to just past zero; it counts as zero
+			x = fmaxl (x, 0.0);
+			for (set = 0; set < NUM_SETS; set++)
+				if (s->o.sets & (1 << set))
+					slot->values[n - first][set] = twz_f (x, twz_w[set], s->powers);
+		}
+
+		pthread_mutex_lock (&s->lock);
+		slot->index = b;
+		pthread_cond_broadcast (&s->batch_done);
+		pthread_mutex_unlock (&s->lock);
+	}
+
+	return NULL;
+}
+
@@ -0,0 +1,115 @@
+//  twz-stream.h
+//
+// Based on source code by the original author: Peter Meyer
+//  Pull the samples of a timewave window in batches from a program,
+//  instead of reading the text of twz-generator.  A small pool of
+//  threads computes a few batches ahead into a bounded ring; it waits
+//  while the ring is full, and closing the stream early cancels the
+//  batches still being computed.
+//
+//	struct twz_stream_options o;
+//	struct twz_stream *s;
+//	struct twz_batch b;
+//
+//	twz_stream_defaults (&o);
+//	o.dtz = 3650; o.neg = 0; o.step = 1; o.wave_factor = 64;
+//	s = twz_stream_open (&o);
+//	while (twz_stream_next (s, &b) > 0)
+//		for (n = 0; n < b.count; n++)
+//			use (b.dtz[n], b.values[n][TWZ_WATKINS]);
+//	twz_stream_close (s);
+//
+//  Link with libtwz.a -lm -lpthread.
+
+// Written for the Linux port
+// 19 Oct 2026
+
+/*
+
+This is free and unencumbered software released into the public domain.
+
+Anyone is free to copy, modify, publish, use, compile, sell, or
+distribute this software, either in source code form or as a compiled
+binary, for any purpose, commercial or non-commercial, and by any
+means.
+
+In jurisdictions that recognize copyright laws, the author or authors
+of this software dedicate any and all copyright interest in the
+software to the public domain. We make this dedication for the benefit
+of the public at large and to the detriment of our heirs and
+successors. We intend this dedication to be an overt act of
+relinquishment in perpetuity of all present and future rights to this
+software under copyright law.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+
+For more information, please refer to <http://unlicense.org/>
+
+09 Dec 2012
+*/
+
+#ifndef TWZ_STREAM_H
+#define TWZ_STREAM_H
+
+#include <stdint.h>
+
+#include "twz-kernel.h"
+
+
+/*  The window, as the arguments of the generators, and how to compute it.
+ *  Zero in the last four fields picks the default.
+ */
+struct twz_stream_options
+{
+	long double dtz;			//  days to zero of the first sample
+	long double neg;			//  0 ends at the zero point, negative stops that many days before it
+	long double step;			//  minutes between samples
+	int64_t wave_factor;		//  2-10000
+	int64_t sets;				//  bit i for set i (default: all)
+	int64_t threads;			//  calculation threads (default: all processors)
+	int64_t batch;				//  samples per batch (default 4096)
+	int64_t depth;				//  batches computed ahead (default 2 per thread)
+};
+
+/*  A batch of consecutive samples.  Sample n of the window is at
+ *  dtz - n * step; values of the sets not asked for are 0.  The arrays
+ *  belong to the stream and stay valid until the next call on it.
+ */
+struct twz_batch
+{
+	int64_t first;				//  index of the first sample in the window
+	int64_t count;
+	const long double *dtz;
+	const long double (*values)[TWZ_SETS];
+};
+
+struct twz_stream;
+
+
+/*  Fill in the defaults: the last 10 days before zero every 60 minutes at
+ *  a wave factor of 64, all sets  */
+void twz_stream_defaults (struct twz_stream_options *o);
+
+/*  Start computing the window.  Returns NULL for invalid options, a window
+ *  that runs past the zero point (neg > 0) among them, or when the threads
+ *  or buffers cannot be had.  */
+struct twz_stream *twz_stream_open (const struct twz_stream_options *o);
+
+/*  Wait for the next batch and hand it over, releasing the previous one
+ *  to the pool.  Returns its sample count, 0 after the last batch.  */
+int64_t twz_stream_next (struct twz_stream *s, struct twz_batch *b);
+
+/*  Number of samples in the window  */
+int64_t twz_stream_samples (struct twz_stream *s);
+
+/*  Cancel whatever is still being computed, wait for the threads and
+ *  free the stream; also at any point before the end  */
+void twz_stream_close (struct twz_stream *s);
+
+#endif
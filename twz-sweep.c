@@ -0,0 +1,278 @@
+//  twz-sweep.c
+//
+// Based on source code by the original author: Peter Meyer
+//  Calculate the timewave within a window for a whole list or range of
+//  wave factors in one run, using multiple threads, and write the
+//  results as one binary wave factor x time matrix.
+
+// Written for the Linux port
+// 19 Oct 2026
+
+/*
+
+This is free and unencumbered software released into the public domain.
+
+Anyone is free to copy, modify, publish, use, compile, sell, or
+distribute this software, either in source code form or as a compiled
+binary, for any purpose, commercial or non-commercial, and by any
+means.
+
+In jurisdictions that recognize copyright laws, the author or authors
+of this software dedicate any and all copyright interest in the
+software to the public domain. We make this dedication for the benefit
+of the public at large and to the detriment of our heirs and
+successors. We intend this dedication to be an overt act of
+relinquishment in perpetuity of all present and future rights to this
+software under copyright law.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+
+For more information, please refer to <http://unlicense.org/>
+
+09 Dec 2012
+*/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+#include <pthread.h>
+
+#include "twz-kernel.h"
+
+
+#define FALSE 0
+#define TRUE  1
+#define NUM_POWERS TWZ_POWERS
+#define PREC 16 // long double (80 bit) numbers have about 16 significant digits  INTEL / AMD / x86_64
+//#define PREC 32 // long double (128 bit) numbers have about 32 significant digits (QUAD PRECISION)
+#define NUM_SETS TWZ_SETS
+#define MAX_THREADS 256
+#define MAX_FACTORS 10000
+#define CHUNK 4096		//  samples per task
+
+
+/*  Binary output format, in the byte order of the machine:
+ *    header    (the struct below, 56 bytes)
+ *    int64_t   wave factor of each row, rows of them
+ *    double    values[rows][cols][sets]
+ *  Column n holds the samples at start - n * step days to zero;
+ *  each cell holds Kelley, Watkins, Sheliak, Huang Ti in that order.
+ */
+struct BinaryHeader
+{
+	char magic[8];		//  "TWZBIN2"
+	int64_t rows, cols, sets;
+	double start, step;
+	int64_t mask;		//  sets present, bit n for set n
+};
+
+
+//  One powers[] table per wave factor, all built before the threads start
+long double (*powers)[NUM_POWERS];
+int64_t *factors;
+int64_t num_factors;
+
+
+char *usage = "\nUsage: twz-sweep [dtz] [neg] [step] [wfs] [file] [threads=nn]."
+"\n dtz = days to zero-point"
+"\n neg = days to calcualte into negative-time (past zero)"
+"\n step = steps in which to decrement time (in minutes)"
+"\n wfs = wave factors, a range like 2:64 or a list like 2,3,64 (range 2-10000)"
+"\n file = binary output file"
+"\n threads = number of calculation threads (default: all processors)"
+"\n\nThis program calculates the running values of the timewave within the given window"
+"\nfor every wave factor and writes them as one binary matrix (see README).\n";
+
+
+int64_t num_samples, chunks_per_row, num_threads, next_task;
+pthread_mutex_t next_lock = PTHREAD_MUTEX_INITIALIZER;
+int out_fd;
+off_t data_offset;
+
+long double dtzp, NegativeBailout, step;
+
+
+void inputerror (void);
+int64_t parse_factors (char *s);
+void *worker (void *arg);
+
+
+/*-----------------------------*/
+int main (int argc, char *argv[])
+{
+	int64_t i, t;
+	pthread_t threads[MAX_THREADS];
+	struct BinaryHeader header;
+
+	if (argc < 6) {
+		printf ("%s", usage);
+		inputerror ();
+	}
+
+	num_threads = sysconf (_SC_NPROCESSORS_ONLN);
+
+	for (i = 6; i < argc; i++) {
+		if (!memcmp (argv[i], "threads=", 8))
+			num_threads = atoi (&argv[i][8]);
+		else {
+			printf ("%s", usage);
+			inputerror ();
+		}
+	}
+
+	if (num_threads < 1)
+		num_threads = 1;
+	if (num_threads > MAX_THREADS)
+		num_threads = MAX_THREADS;
+
+	dtzp = atof (&argv[1][0]);
+
+	NegativeBailout = atof (&argv[2][0]);
+	NegativeBailout *= -1;
+
+	step = atof (&argv[3][0]);
+	step /= 60;		// Convert to 60 minute hours
+	step /= 24;		// Convert to 24 hour days
+
+	if (step <= 0 || dtzp < NegativeBailout || !parse_factors (argv[4])) {
+		printf ("%s", usage);
+		inputerror ();
+	}
+
+	powers = malloc (num_factors * sizeof (*powers));
+	if (powers == NULL)
+		inputerror ();
+	for (i = 0; i < num_factors; i++)
+		twz_powers (powers[i], factors[i]);
+
+	num_samples = (int64_t) ((dtzp - NegativeBailout) / step) + 1;
+	chunks_per_row = (num_samples + CHUNK - 1) / CHUNK;
+
+	out_fd = open (argv[5], O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (out_fd < 0)
+		inputerror ();
+
+	memset (&header, 0, sizeof (header));
+	strcpy (header.magic, "TWZBIN2");
+	header.rows = num_factors;
+	header.cols = num_samples;
+	header.sets = NUM_SETS;
+	header.start = dtzp;
+	header.step = step;
+	header.mask = (1 << NUM_SETS) - 1;
+
+	data_offset = sizeof (header) + num_factors * sizeof (int64_t);
+	if (pwrite (out_fd, &header, sizeof (header), 0) != sizeof (header)
+		|| pwrite (out_fd, factors, num_factors * sizeof (int64_t), sizeof (header)) != num_factors * sizeof (int64_t)
+		|| ftruncate (out_fd, data_offset + num_factors * num_samples * NUM_SETS * sizeof (double)))
+		inputerror ();
+
+	// Tasks are (wave factor, chunk of samples) pairs; every task writes its own part of the file
+	next_task = 0;
+	for (t = 0; t < num_threads; t++)
+		pthread_create (&threads[t], NULL, worker, NULL);
+	for (t = 0; t < num_threads; t++)
+		pthread_join (threads[t], NULL);
+
+	close (out_fd);
+
+	return 0;
+}
+
+
+
+//  Calculation thread: take (wave factor, chunk) tasks until none are left
+/*--------------*/
+void *worker (void *arg)
+{
+	int64_t task, row, first, n, count, number_set;
+	double *values = malloc (CHUNK * NUM_SETS * sizeof (double));
+	size_t bytes;
+
+	if (values == NULL)
+		inputerror ();
+
+	for (;;) {
+		pthread_mutex_lock (&next_lock);
+		task = next_task++;
+		pthread_mutex_unlock (&next_lock);
+
+		if (task >= num_factors * chunks_per_row)
+			break;
+
+		row = task / chunks_per_row;
+		first = (task % chunks_per_row) * CHUNK;
+		count = num_samples - first < CHUNK ? num_samples - first : CHUNK;
+
+		for (n = 0; n < count; n++)
+			for (number_set = 0; number_set < NUM_SETS; number_set++)
+				values[n * NUM_SETS + number_set] = twz_f (dtzp - (first + n) * step, twz_w[number_set], powers[row]);
+
+		bytes = count * NUM_SETS * sizeof (double);
+		if (pwrite (out_fd, values, bytes, data_offset + (row * num_samples + first) * NUM_SETS * sizeof (double)) != bytes) {
+			perror ("twz-sweep");
+			exit (EXIT_FAILURE);
+		}
+	}
+
+	free (values);
+	return NULL;
+}
+
+
+
+//  Wave factors as a range "a:b" or a list "a,b,c"
+/*--------------*/
+int64_t parse_factors (char *s)
+{
+	int64_t a, b, i;
+	char *p;
+
+	factors = malloc (MAX_FACTORS * sizeof (int64_t));
+	if (factors == NULL)
+		inputerror ();
+
+	num_factors = 0;
+
+	if ((p = strchr (s, ':')) != NULL) {
+		a = atoi (s);
+		b = atoi (p + 1);
+		if (a < 2 || b > 10000 || a > b)
+			return FALSE;
+		for (i = a; i <= b; i++)
+			factors[num_factors++] = i;
+		return TRUE;
+	}
+
+	for (p = s; *p && num_factors < MAX_FACTORS; ) {
+		a = strtol (p, &p, 10);
+		if (a < 2 || a > 10000)
+			return FALSE;
+		factors[num_factors++] = a;
+		if (*p == ',')
+			p++;
+		else if (*p)
+			return FALSE;
+	}
+
+	return num_factors > 0;
+}
+
+
+
+void inputerror (void)
+{
+	printf ("\nError: Invalid input, exiting.\n\n");
+	exit (EXIT_SUCCESS);
+}
@@ -0,0 +1,629 @@
+//  twz-zoom.c
+//
+// Based on source code by the original author: Peter Meyer
+//  Render a zoom sequence closing in on the zero point in one run.  The
+//  values at the level breakpoints are cached across frames, so each frame
+//  only calculates the detail that has newly come into view.
+
+// Written for the Linux port
+// 19 Oct 2026
+
+/*
+
+This is free and unencumbered software released into the public domain.
+
+Anyone is free to copy, modify, publish, use, compile, sell, or
+distribute this software, either in source code form or as a compiled
+binary, for any purpose, commercial or non-commercial, and by any
+means.
+
+In jurisdictions that recognize copyright laws, the author or authors
+of this software dedicate any and all copyright interest in the
+software to the public domain. We make this dedication for the benefit
+of the public at large and to the detriment of our heirs and
+successors. We intend this dedication to be an overt act of
+relinquishment in perpetuity of all present and future rights to this
+software under copyright law.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+
+For more information, please refer to <http://unlicense.org/>
+
+09 Dec 2012
+*/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <pthread.h>
+
+#include "twz-kernel.h"
+
+
+#define FALSE 0
+#define TRUE  1
+#define NUM_POWERS TWZ_POWERS
+#define PREC 16 // long double (80 bit) numbers have about 16 significant digits  INTEL / AMD / x86_64
+//#define PREC 32 // long double (128 bit) numbers have about 32 significant digits (QUAD PRECISION)
+#define NUM_SETS TWZ_SETS
+#define MAX_THREADS 256
+#define MAX_BREAKS 64		//  most level breakpoints evaluated per pixel column
+#define MAX_PIXELS 65536	//  largest image width or height
+#define MAX_FRAMES 100000
+#define MIN_EXPONENT (-(NUM_POWERS - 1))
+
+
+/*  One frame: the window from dtz down to the zero point, split into
+ *  width columns.  The edges are the samples of the binary series and
+ *  the ends of the columns; the images show the minimum and maximum of
+ *  every column.
+ */
+struct Frame
+{
+	long double dtz;
+	long double (*edge)[NUM_SETS];		//  width + 1 values, from dtz down to 0
+	long double (*col_min)[NUM_SETS], (*col_max)[NUM_SETS];
+};
+
+/*  Every level of f() is linear between multiples of its spacing, a power
+ *  of the wave factor, so the breakpoints of a frame are multiples m * h
+ *  of h = wf^e.  The frames shrink towards zero, so later frames need the
+ *  same multiples again, or a finer h whose every wf-th multiple is a
+ *  point of the coarser grid.  value[m] is NAN until calculated.
+ */
+struct Grid
+{
+	int64_t e;
+	int64_t size;
+	long double (*value)[NUM_SETS];
+};
+
+/*  Binary frames (.bin), the format of twz-sweep with a single row  */
+struct BinaryHeader
+{
+	char magic[8];		//  "TWZBIN2"
+	int64_t rows, cols, sets;
+	double start, step;
+	int64_t mask;		//  sets present, bit n for set n
+};
+
+
+long double powers[NUM_POWERS];
+
+//  Powers of (normally) 64.
+//  Due to the limitations of double precision
+//  floating point arithmetic these values are
+//  exact only up to powers[8] for powers of 64.
+
+int64_t wave_factor = 64;		//  default wave factor
+
+
+char *usage = "\nUsage: twz-zoom [dtz] [frames] [per_octave] [width] [height] [wf] [file] [options]."
+"\n dtz = days to zero-point of the first frame"
+"\n frames = number of frames"
+"\n per_octave = frames for every factor wf the window shrinks by"
+"\n width, height = size of the frames in pixels (width samples + 1 in .bin frames)"
+"\n wf = wave factor (default 64, range 2-10000)"
+"\n file = name of the frames, numbered before the extension: .ppm, .svg or .bin"
+"\n\nOptions:"
+"\n threads=n = number of calculation threads (default: all processors)"
+"\n similar = draw the frames from the second octave on from the frame an"
+"\n           octave earlier, scaled by 1/wf, instead of calculating them"
+"\n\nFrame k shows the timewave from dtz / wf^(k/per_octave) days down to the zero point.\n";
+
+
+char *set_name[NUM_SETS] =
+{ "Kelley", "Watkins", "Sheliak", "Huang Ti" };
+
+//  Colour of each number set in the image
+unsigned char set_color[NUM_SETS][3] =
+{ { 200, 30, 30 }, { 30, 30, 200 }, { 30, 150, 30 }, { 200, 140, 0 } };
+
+
+struct Frame *frames;			//  the last per_octave frames, frame k in frames[k % per_octave]
+struct Frame *frame;			//  the frame being calculated
+struct Grid grids[2];			//  the grid of the frame and the next coarser one
+struct Grid *grid;
+long double column_width;
+
+int64_t width, height, per_octave, num_threads;
+int64_t next_task, num_tasks;
+int64_t drawn, calculated;		//  breakpoint values used and calculated
+pthread_mutex_t next_lock = PTHREAD_MUTEX_INITIALIZER;
+
+
+void inputerror (void);
+void set_grid (int64_t e, long double dtz);
+long double grid_x (int64_t e, int64_t m);
+long double spacing (int64_t e);
+void *edge_worker (void *arg);
+void *column_worker (void *arg);
+void run (void *(*task) (void *), int64_t tasks);
+void column (int64_t c);
+void frame_name (char *name, char *file, int64_t k);
+void write_frame (char *name, char *ext);
+int64_t pixel_row (long double y, long double lo, long double hi);
+void write_ppm (FILE *out, long double lo, long double hi);
+void write_svg (FILE *out, long double lo, long double hi);
+void write_bin (FILE *out);
+
+long double mult_power (long double x, int64_t i);
+long double div_power (long double x, int64_t i);
+
+
+/*-----------------------------*/
+int main (int argc, char *argv[])
+{
+	int64_t i, k, e, c, set, num_frames, similar = FALSE;
+	long double dtzp;
+	struct Frame *earlier;
+	char *ext, *name;
+
+	if (argc < 8) {
+		printf ("%s", usage);
+		inputerror ();
+	}
+
+	num_threads = sysconf (_SC_NPROCESSORS_ONLN);
+
+	for (i = 8; i < argc; i++) {
+		if (!memcmp (argv[i], "threads=", 8))
+			num_threads = atoi (&argv[i][8]);
+		else if (!strcmp (argv[i], "similar"))
+			similar = TRUE;
+		else {
+			printf ("%s", usage);
+			inputerror ();
+		}
+	}
+
+	if (num_threads < 1)
+		num_threads = 1;
+	if (num_threads > MAX_THREADS)
+		num_threads = MAX_THREADS;
+
+	dtzp = atof (&argv[1][0]);
+	num_frames = atol (&argv[2][0]);
+	per_octave = atol (&argv[3][0]);
+	width = atoi (&argv[4][0]);
+	height = atoi (&argv[5][0]);
+	wave_factor = atoi (&argv[6][0]);
+
+	ext = strrchr (argv[7], '.');
+
+	if (wave_factor < 2 || wave_factor > 10000 || dtzp <= 0 || num_frames < 1 || num_frames > MAX_FRAMES
+		|| per_octave < 1 || per_octave > MAX_FRAMES || width < 1 || width > MAX_PIXELS || height < 2 
+		|| height > MAX_PIXELS || ext == NULL || (strcmp (ext, ".ppm") && strcmp (ext, ".svg") && strcmp (ext, ".bin"))) {
+		printf ("%s", usage);
+		inputerror ();
+	}
+
+	twz_powers (powers, wave_factor);
+
+	frames = calloc (per_octave, sizeof (struct Frame));
+	name = malloc (strlen (argv[7]) + 32);
+	if (frames == NULL || name == NULL)
+		inputerror ();
+	for (i = 0; i < per_octave; i++) {
+		frames[i].edge = malloc ((width + 1) * sizeof (*frames[i].edge));
+		frames[i].col_min = calloc (width, sizeof (*frames[i].col_min));
+		frames[i].col_max = calloc (width, sizeof (*frames[i].col_max));
+		if (frames[i].edge == NULL || frames[i].col_min == NULL || frames[i].col_max == NULL)
+			inputerror ();
+	}
+	grids[0].value = grids[1].value = NULL;
+
+	for (k = 0; k < num_frames; k++) {
+		frame = &frames[k % per_octave];
+
+		// Exactly wf times smaller than the frame an octave earlier
+		frame->dtz = div_power (dtzp * powl (wave_factor, -(long double) (k % per_octave) / per_octave), k / per_octave);
+		column_width = frame->dtz / width;
+
+		if (similar && k >= per_octave) {
+			// f(x / wf) = f(x) / wf, up to where f() truncates its fine loop.
+			// The earlier frame sits in the same slot of the ring.
+			earlier = frame;
+			for (c = 0; c <= width; c++)
+				for (set = 0; set < NUM_SETS; set++) {
+					earlier->edge[c][set] /= wave_factor;
+					if (c < width) {
+						earlier->col_min[c][set] /= wave_factor;
+						earlier->col_max[c][set] /= wave_factor;
+					}
+				}
+		} else {
+			run (edge_worker, width + 1);
+
+			// The spacing of the finest levels with at most MAX_BREAKS
+			// breakpoints in a column, as in twz-render; binary frames
+			// only hold the edges
+			for (e = 0; e < NUM_POWERS - 1 && column_width / spacing (e) > MAX_BREAKS; e++)
+				;
+			for (; e > MIN_EXPONENT && column_width / spacing (e - 1) <= MAX_BREAKS; e--)
+				;
+			if (strcmp (ext, ".bin")) {
+				set_grid (e, frame->dtz);
+				run (column_worker, width);
+			}
+		}
+
+		frame_name (name, argv[7], k);
+		write_frame (name, ext);
+	}
+
+	fprintf (stderr, "%ld frames; %ld breakpoint values used, %ld calculated (%.1Lf%%)\n", num_frames, 
+		drawn, calculated, drawn ? 100.0L * calculated / drawn : 0.0L);
+
+	return 0;
+}
+
+
+
+/*  Make the grid of h = wf^e current, big enough for a frame down from dtz.
+ *  A finer grid takes over every wf-th value of the current one; grids
+ *  coarser than that are no longer needed.
+ */
+/*--------------*/
+void set_grid (int64_t e, long double dtz)
+{
+	int64_t m;
+	struct Grid g, *coarse = NULL;
+
+	if (grids[0].value && grids[0].e == e) {
+		grid = &grids[0];
+		return;
+	}
+
+	if (grids[0].value && grids[0].e == e + 1)
+		coarse = &grids[0];
+
+	g.e = e;
+	g.size = (int64_t) ceill (dtz / spacing (e)) + 2;
+	g.value = malloc (g.size * sizeof (*g.value));
+	if (g.value == NULL) {
+		printf ("\nError: Out of memory, exiting.\n\n");
+		exit (EXIT_FAILURE);
+	}
+
+	for (m = 0; m < g.size; m++) {
+		if (coarse && m % wave_factor == 0 && m / wave_factor < coarse->size)
+			memcpy (g.value[m], coarse->value[m / wave_factor], sizeof (g.value[m]));
+		else
+			g.value[m][0] = NAN;
+	}
+
+	free (grids[1].value);
+	if (coarse) {
+		grids[1] = grids[0];
+	} else {
+		free (grids[0].value);
+		grids[1].value = NULL;
+	}
+	grids[0] = g;
+	grid = &grids[0];
+}
+
+
+
+//  The breakpoint m * wf^e, from exact powers so the finer grids meet the coarser ones
+/*--------------*/
+long double grid_x (int64_t e, int64_t m)
+{
+	return e >= 0 ? mult_power ((long double) m, e) : div_power ((long double) m, -e);
+}
+
+
+
+/*--------------*/
+long double spacing (int64_t e)
+{
+	return grid_x (e, 1);
+}
+
+
+
+//  Hand out tasks 0 .. tasks - 1 to the threads and wait for them
+/*--------------*/
+void run (void *(*task) (void *), int64_t tasks)
+{
+	pthread_t threads[MAX_THREADS];
+	int64_t t;
+
+	next_task = 0;
+	num_tasks = tasks;
+	for (t = 0; t < num_threads; t++)
+		pthread_create (&threads[t], NULL, task, NULL);
+	for (t = 0; t < num_threads; t++)
+		pthread_join (threads[t], NULL);
+}
+
+
+
+//  Calculation thread: the column edges of the frame, from dtz down to zero
+/*--------------*/
+void *edge_worker (void *arg)
+{
+	int64_t c, set;
+
+	for (;;) {
+		pthread_mutex_lock (&next_lock);
+		c = next_task++;
+		pthread_mutex_unlock (&next_lock);
+
+		if (c >= num_tasks)
+			break;
+
+		for (set = 0; set < NUM_SETS; set++)
+			frame->edge[c][set] = c == width ? twz_f (0.0, twz_w[set], powers) : twz_f (frame->dtz - c * column_width, twz_w[set], powers);
+	}
+
+	return NULL;
+}
+
+
+
+//  Calculation thread: the minimum and maximum of the columns
+/*--------------*/
+void *column_worker (void *arg)
+{
+	int64_t c;
+
+	for (;;) {
+		pthread_mutex_lock (&next_lock);
+		c = next_task++;
+		pthread_mutex_unlock (&next_lock);
+
+		if (c >= num_tasks)
+			break;
+
+		column (c);
+	}
+
+	return NULL;
+}
+
+
+
+/*  Column c runs from edge c + 1 up to edge c; in between, f() at the
+ *  multiples of the grid spacing gives the exact minimum and maximum of
+ *  the levels at least that coarse (see twz-render).  Every breakpoint
+ *  lies in one column only, so the threads never fill the same one.
+ */
+/*--------------*/
+void column (int64_t c)
+{
+	int64_t m, i, set, used = 0, new = 0;
+	long double a, b, *y;
+
+	b = frame->dtz - c * column_width;
+	a = c == width - 1 ? 0.0 : b - column_width;
+
+	for (set = 0; set < NUM_SETS; set++) {
+		frame->col_min[c][set] = fminl (frame->edge[c][set], frame->edge[c + 1][set]);
+		frame->col_max[c][set] = fmaxl (frame->edge[c][set], frame->edge[c + 1][set]);
+	}
+
+	for (m = (int64_t) floorl (a / spacing (grid->e)) + 1, i = 0; m < grid->size && grid_x (grid->e, m) < b && i < MAX_BREAKS; m++, i++) {
+		if (grid_x (grid->e, m) <= a)
+			continue;
+
+		y = grid->value[m];
+		if (isnan (y[0])) {
+			for (set = 0; set < NUM_SETS; set++)
+				y[set] = twz_f (grid_x (grid->e, m), twz_w[set], powers);
+			new++;
+		}
+		used++;
+
+		for (set = 0; set < NUM_SETS; set++) {
+			if (y[set] < frame->col_min[c][set])
+				frame->col_min[c][set] = y[set];
+			if (y[set] > frame->col_max[c][set])
+				frame->col_max[c][set] = y[set];
+		}
+	}
+
+	pthread_mutex_lock (&next_lock);
+	drawn += used;
+	calculated += new;
+	pthread_mutex_unlock (&next_lock);
+}
+
+
+
+//  "zoom.ppm" becomes "zoom-0000.ppm", "zoom-0001.ppm", ...
+/*--------------*/
+void frame_name (char *name, char *file, int64_t k)
+{
+	char *ext = strrchr (file, '.');
+
+	memcpy (name, file, ext - file);
+	sprintf (name + (ext - file), "-%04ld%s", k, ext);
+}
+
+
+
+//  One vertical scale for all the sets of the frame, as in twz-render
+/*--------------*/
+void write_frame (char *name, char *ext)
+{
+	int64_t c, set;
+	long double lo = INFINITY, hi = -INFINITY;
+	FILE *out = fopen (name, "wb");
+
+	if (out == NULL) {
+		perror (name);
+		exit (EXIT_FAILURE);
+	}
+
+	if (!strcmp (ext, ".bin"))
+		write_bin (out);
+	else {
+		for (c = 0; c < width; c++)
+			for (set = 0; set < NUM_SETS; set++) {
+				if (frame->col_min[c][set] < lo)
+					lo = frame->col_min[c][set];
+				if (frame->col_max[c][set] > hi)
+					hi = frame->col_max[c][set];
+			}
+		if (hi <= lo)
+			hi = lo + 1.0;
+
+		if (!strcmp (ext, ".ppm"))
+			write_ppm (out, lo, hi);
+		else
+			write_svg (out, lo, hi);
+	}
+
+	if (fclose (out)) {
+		perror (name);
+		exit (EXIT_FAILURE);
+	}
+}
+
+
+
+//  Row of the image for value y; row 0 is the top
+/*--------------*/
+int64_t pixel_row (long double y, long double lo, long double hi)
+{
+	int64_t r = (int64_t) lrintl ((hi - y) / (hi - lo) * (height - 1));
+
+	if (r < 0)
+		r = 0;
+	if (r > height - 1)
+		r = height - 1;
+	return r;
+}
+
+
+
+//  Binary PPM raster: each set is a vertical bar from its column minimum
+//  to its column maximum, drawn in the set's colour on white
+/*--------------*/
+void write_ppm (FILE *out, long double lo, long double hi)
+{
+	int64_t c, r, top, bottom, number_set;
+	unsigned char *image = malloc (width * height * 3);
+
+	if (image == NULL)
+		inputerror ();
+
+	memset (image, 255, width * height * 3);
+
+	for (c = 0; c < width; c++) {
+		for (number_set = NUM_SETS - 1; number_set >= 0; number_set--) {
+			top = pixel_row (frame->col_max[c][number_set], lo, hi);
+			bottom = pixel_row (frame->col_min[c][number_set], lo, hi);
+			for (r = top; r <= bottom; r++)
+				memcpy (&image[(r * width + c) * 3], set_color[number_set], 3);
+		}
+	}
+
+	fprintf (out, "P6\n# timewave from %.*Lf to 0 days to zero, wave factor %ld\n"
+		"# values from %.*Lf (bottom) to %.*Lf (top)\n%ld %ld\n255\n",
+		PREC, frame->dtz, wave_factor, PREC, lo, PREC, hi, width, height);
+	fwrite (image, 3, width * height, out);
+	free (image);
+}
+
+
+
+//  SVG drawing: one polyline per set running down and up every column
+//  between the column minimum and maximum
+/*--------------*/
+void write_svg (FILE *out, long double lo, long double hi)
+{
+	int64_t c, number_set;
+
+	fprintf (out, "<?xml version=\"1.0\"?>\n"
+		"<!-- timewave from %.*Lf to 0 days to zero, wave factor %ld -->\n"
+		"<!-- values from %.*Lf (bottom) to %.*Lf (top) -->\n"
+		"<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"%ld\" height=\"%ld\">\n"
+		"<rect width=\"100%%\" height=\"100%%\" fill=\"white\"/>\n",
+		PREC, frame->dtz, wave_factor, PREC, lo, PREC, hi, width, height);
+
+	for (number_set = 0; number_set < NUM_SETS; number_set++) {
+		fprintf (out, "<polyline fill=\"none\" stroke-width=\"1\" stroke=\"rgb(%d,%d,%d)\" points=\"",
+			set_color[number_set][0], set_color[number_set][1], set_color[number_set][2]);
+
+		// Alternate the direction of travel so consecutive columns join up
+		for (c = 0; c < width; c++) {
+			if (c % 2)
+				fprintf (out, "%ld.5,%ld %ld.5,%ld ", c, pixel_row (frame->col_min[c][number_set], lo, hi),
+					c, pixel_row (frame->col_max[c][number_set], lo, hi));
+			else
+				fprintf (out, "%ld.5,%ld %ld.5,%ld ", c, pixel_row (frame->col_max[c][number_set], lo, hi),
+					c, pixel_row (frame->col_min[c][number_set], lo, hi));
+		}
+
+		fprintf (out, "\"><title>%s</title></polyline>\n", set_name[number_set]);
+	}
+
+	fprintf (out, "</svg>\n");
+}
+
+
+
+//  The width + 1 column edges as a binary series (see README)
+/*--------------*/
+void write_bin (FILE *out)
+{
+	struct BinaryHeader header;
+	double row[NUM_SETS];
+	int64_t c, set;
+
+	memset (&header, 0, sizeof (header));
+	strcpy (header.magic, "TWZBIN2");
+	header.rows = 1;
+	header.cols = width + 1;
+	header.sets = NUM_SETS;
+	header.start = frame->dtz;
+	header.step = column_width;
+	header.mask = (1 << NUM_SETS) - 1;
+	fwrite (&header, sizeof (header), 1, out);
+	fwrite (&wave_factor, sizeof (int64_t), 1, out);
+
+	for (c = 0; c <= width; c++) {
+		for (set = 0; set < NUM_SETS; set++)
+			row[set] = frame->edge[c][set];
+		fwrite (row, sizeof (row), 1, out);
+	}
+}
+
+
+
+/*-----------------------*/
+long double mult_power (long double x, int64_t i)
+{
+	x *= powers[i];
+	return (x);
+}
+
+
+
+/*----------------------*/
+long double div_power (long double x, int64_t i)
+{
+	x /= powers[i];
+	return (x);
+}
+
+
+
+void inputerror (void)
+{
+	printf ("\nError: Invalid input, exiting.\n\n");
+	exit (EXIT_SUCCESS);
+}